@@ -1,35 +1,12 @@
-#include <fstream>
-
 #include "ast.h"
 #include "errors.h"
-
-tiny::ASTNode::ASTNode(tiny::Metadata meta, tiny::ASTNodeType t, const tiny::ASTNode& c1)
-        :type(t), meta(std::move(meta))
-{
-    addChildren(c1);
-}
-
-tiny::ASTNode::ASTNode(tiny::Metadata meta, tiny::ASTNodeType t, const tiny::ASTNode& c1, const tiny::ASTNode& c2)
-        :type(t), meta(std::move(meta))
-{
-    addChildren(c1);
-    addChildren(c2);
-}
-
-tiny::ASTNode::ASTNode(tiny::Metadata meta, tiny::ASTNodeType t, const tiny::ASTNode& c1, const tiny::ASTNode& c2,
-        const tiny::ASTNode& c3)
-        :type(t), meta(std::move(meta))
-{
-    addChildren(c1);
-    addChildren(c2);
-    addChildren(c3);
-}
+#include "jsonwriter.h"
 
 nlohmann::json tiny::ASTFile::toJson() const
 {
     std::vector<nlohmann::json> jsonStmts;
-    for (auto& s: statements) {
-        jsonStmts.push_back(s.toJson());
+    for (auto s: statements) {
+        jsonStmts.push_back(nodes.toJson(s));
     }
 
     std::vector<nlohmann::json> jsonImports;
@@ -37,7 +14,7 @@ nlohmann::json tiny::ASTFile::toJson() const
         jsonImports.push_back(i.toJson());
     }
 
-    return nlohmann::json{
+    nlohmann::json json{
             {"file", {
                     {"path", file.path.string()},
                     {"module", mod.toString()},
@@ -45,34 +22,149 @@ nlohmann::json tiny::ASTFile::toJson() const
                     {"statements", jsonStmts}
             }},
     };
+
+    if (!comments.empty()) {
+        std::vector<nlohmann::json> jsonComments;
+        for (auto& c: comments) {
+            jsonComments.push_back(c.toJson());
+        }
+
+        json["file"]["comments"] = jsonComments;
+    }
+
+    return json;
+}
+
+namespace {
+    // Writes the fields of an ASTFile's object that precede the statements. Keys are sorted like in nlohmann::json
+    void writeFileFields(const tiny::ASTFile &ast, tiny::JSONWriter &writer)
+    {
+        if (!ast.comments.empty()) {
+            writer.key("comments");
+            writer.beginArray();
+            for (auto& c: ast.comments) {
+                c.writeJson(writer);
+            }
+            writer.endArray();
+        }
+
+        writer.key("imports");
+        writer.beginArray();
+        for (auto& i: ast.imports) {
+            i.writeJson(writer);
+        }
+        writer.endArray();
+
+        writer.key("module");
+        writer.value(ast.mod.toString());
+        writer.key("path");
+        writer.value(ast.file.path.string());
+    }
 }
 
-nlohmann::json tiny::ASTNode::toJson() const
+void tiny::ASTFile::writeJson(tiny::JSONWriter &writer) const
 {
-    nlohmann::json json;
-    json["type"] = toString();
+    writer.beginObject();
+    writer.key("file");
+    writer.beginObject();
 
-    std::vector<nlohmann::json> childrenJson;
-    for (auto& c: children) {
-        childrenJson.push_back(c->toJson());
+    writeFileFields(*this, writer);
+
+    writer.key("statements");
+    writer.beginArray();
+    for (auto s: statements) {
+        nodes.writeJson(s, writer);
     }
+    writer.endArray();
 
-    json["children"] = childrenJson;
+    writer.endObject();
+    writer.endObject();
+}
 
-    if (auto strVal = tiny::toString(val); !strVal.empty()) {
-        json["value"] = strVal;
+void tiny::ASTFile::writeJsonLines(tiny::JSONWriter &writer) const
+{
+    writer.beginObject();
+    writer.key("file");
+    writer.beginObject();
+    writeFileFields(*this, writer);
+    writer.endObject();
+    writer.endObject();
+    writer.endLine();
+
+    for (auto s: statements) {
+        nodes.writeJson(s, writer);
+        writer.endLine();
     }
+}
 
-    if (!params.empty()) {
-        std::vector<nlohmann::json> jsonParams;
-        for (auto& p: params) {
-            jsonParams.push_back(p.toJson());
+nlohmann::json tiny::ASTArena::toJson(tiny::NodeId id) const
+{
+    // Objects of the nodes being visited. A node is appended to its parent once its children are done
+    std::vector<nlohmann::json> pending;
+    nlohmann::json result;
+
+    walk(id, [&](tiny::NodeId n) {
+        pending.push_back({{"type", nodes[n].toString()}, {"children", nlohmann::json::array()}});
+        return true;
+    }, [&](tiny::NodeId n) {
+        auto const& node = nodes[n];
+        auto json = std::move(pending.back());
+        pending.pop_back();
+
+        if (auto strVal = toString(node.val); !strVal.empty()) {
+            json["value"] = strVal;
         }
 
-        json["parameters"] = jsonParams;
-    }
+        if (auto params = node.getParams(); !params.empty()) {
+            std::vector<nlohmann::json> jsonParams;
+            for (auto& p: params) {
+                jsonParams.push_back(p.toJson());
+            }
 
-    return json;
+            json["parameters"] = jsonParams;
+        }
+
+        if (pending.empty()) {
+            result = std::move(json);
+        } else {
+            pending.back()["children"].push_back(std::move(json));
+        }
+    });
+
+    return result;
+}
+
+void tiny::ASTArena::writeJson(tiny::NodeId id, tiny::JSONWriter &writer) const
+{
+    // The children go first, as "children" is the first key in order
+    walk(id, [&](tiny::NodeId) {
+        writer.beginObject();
+        writer.key("children");
+        writer.beginArray();
+        return true;
+    }, [&](tiny::NodeId n) {
+        auto const& node = nodes[n];
+        writer.endArray();
+
+        if (auto params = node.getParams(); !params.empty()) {
+            writer.key("parameters");
+            writer.beginArray();
+            for (auto& p: params) {
+                p.writeJson(writer);
+            }
+            writer.endArray();
+        }
+
+        writer.key("type");
+        writer.value(node.toString());
+
+        if (auto strVal = toString(node.val); !strVal.empty()) {
+            writer.key("value");
+            writer.value(strVal);
+        }
+
+        writer.endObject();
+    });
 }
 
 std::string tiny::ASTNode::toString() const
@@ -238,19 +330,71 @@ nlohmann::json tiny::Parameter::toJson() const
     };
 }
 
+void tiny::Parameter::writeJson(tiny::JSONWriter &writer) const
+{
+    writer.beginObject();
+    writer.key("type");
+    writer.value(toString());
+    writer.key("value");
+    writer.value(tiny::toString(val));
+    writer.endObject();
+}
+
+nlohmann::json tiny::Comment::toJson() const
+{
+    auto [line, col] = meta.getPosition();
+
+    return nlohmann::json{
+            {"text", text},
+            {"multiline", multiline},
+            {"line", line},
+            {"column", col},
+    };
+}
+
+void tiny::Comment::writeJson(tiny::JSONWriter &writer) const
+{
+    auto [line, col] = meta.getPosition();
+
+    writer.beginObject();
+    writer.key("column");
+    writer.value(col);
+    writer.key("line");
+    writer.value(line);
+    writer.key("multiline");
+    writer.value(multiline);
+    writer.key("text");
+    writer.value(text);
+    writer.endObject();
+}
+
 nlohmann::json tiny::Import::toJson() const
 {
     nlohmann::json json{
             {"module", mod.toString()},
     };
 
-    if (!alias) {
+    if (!alias.empty()) {
         json["alias"] = alias.toString();
     }
 
     return json;
 }
 
+void tiny::Import::writeJson(tiny::JSONWriter &writer) const
+{
+    writer.beginObject();
+
+    if (!alias.empty()) {
+        writer.key("alias");
+        writer.value(alias.toString());
+    }
+
+    writer.key("module");
+    writer.value(mod.toString());
+    writer.endObject();
+}
+
 std::string tiny::Parameter::toString() const
 {
     switch (type) {
@@ -280,116 +424,190 @@ std::string tiny::Parameter::toString() const
     }
 }
 
-tiny::String tiny::Parameter::getStringVal(const Metadata& meta) const
+tiny::Symbol tiny::Parameter::getStringVal(const Metadata& meta) const
 {
-    if (!std::holds_alternative<tiny::String>(val)) {
+    if (!val.holds<tiny::Symbol>()) {
         throw tiny::NoSuchValue("Tried to get the string value of a node that didn't contain one", meta);
     }
 
-    return std::get<tiny::String>(val);
+    return val.get<tiny::Symbol>();
 }
 
 std::string tiny::toString(tiny::Value val)
 {
-    if (std::holds_alternative<tiny::String>(val)) {
-        return std::get<tiny::String>(val).toString();
+    switch (val.getKind()) {
+    case tiny::Value::Kind::Symbol:
+        return val.get<tiny::Symbol>().toString();
+    case tiny::Value::Kind::Int:
+        return std::to_string(val.get<std::int64_t>());
+    case tiny::Value::Kind::UInt:
+        return std::to_string(val.get<std::uint64_t>());
+    case tiny::Value::Kind::Decimal:
+        throw std::bad_variant_access();
+    case tiny::Value::Kind::Bool:
+        return val.get<bool>() ? "True" : "False";
     }
 
-    if (std::holds_alternative<std::int64_t>(val)) {
-        return std::to_string(std::get<std::int64_t>(val));
-    }
+    return ""; // Empty val
+}
 
-    if (std::holds_alternative<std::uint64_t>(val)) {
-        return std::to_string(std::get<std::uint64_t>(val));
+std::string tiny::ASTArena::toString(const tiny::Value &val) const
+{
+    if (val.holds<tiny::DecimalId>()) {
+        return std::to_string(getDecimal(val.get<tiny::DecimalId>()));
     }
 
-    if (std::holds_alternative<long double>(val)) {
-        return std::to_string(std::get<long double>(val));
+    return tiny::toString(val);
+}
+
+bool tiny::Value::operator==(const tiny::Value& rhs) const
+{
+    if (kind!=rhs.kind) {
+        return false;
     }
 
-    if (std::holds_alternative<bool>(val)) {
-        return std::get<bool>(val) ? "True" : "False";
+    switch (kind) {
+    case Kind::Symbol:
+        return payload.symbol==rhs.payload.symbol;
+    case Kind::Int:
+        return payload.integer==rhs.payload.integer;
+    case Kind::UInt:
+        return payload.unsignedInteger==rhs.payload.unsignedInteger;
+    case Kind::Decimal:
+        return payload.decimal==rhs.payload.decimal;
+    case Kind::Bool:
+        return payload.boolean==rhs.payload.boolean;
     }
 
-    return ""; // Empty val
+    return false;
+}
+
+namespace {
+    //! Gets the bit of a ParameterType inside ASTNode::flags
+    std::uint16_t flagOf(tiny::ParameterType t)
+    {
+        static_assert(std::size_t(tiny::ParameterType::ComputedAccess)<16, "ParameterType doesn't fit in the flags");
+        return std::uint16_t(1u << std::size_t(t));
+    }
 }
 
 tiny::Parameter tiny::ASTNode::getParam(tiny::ParameterType t) const
 {
-    for (const auto& p: params) {
-        if (p.type==t) {
-            return p;
-        }
+    if (hasParam(t)) {
+        return tiny::isFlag(t) ? tiny::Parameter(t) : param;
     }
 
     throw tiny::NoSuchParameter("Parameter of type '" + tiny::Parameter(t).toString() + "' expected but not found", meta);
 }
 
-bool tiny::ASTNode::hasParam(tiny::ParameterType t) const
+std::vector<tiny::Parameter> tiny::ASTNode::getParams() const
 {
-    return std::any_of(params.begin(), params.end(), [&t](auto p){return p.type == t;});
+    std::vector<tiny::Parameter> params;
+    for (std::size_t t = 0; t<=std::size_t(tiny::ParameterType::ComputedAccess); t++) {
+        if (hasParam(tiny::ParameterType(t))) {
+            params.push_back(getParam(tiny::ParameterType(t)));
+        }
+    }
+
+    return params;
 }
 
-void tiny::ASTNode::addParam(const tiny::Parameter& p)
+bool tiny::ASTNode::hasParam(tiny::ParameterType t) const
 {
-    params.push_back(p);
+    if (tiny::isFlag(t)) {
+        return flags & flagOf(t);
+    }
+
+    return t!=tiny::ParameterType::None && param.type==t;
 }
 
-std::shared_ptr<tiny::ASTNode> tiny::ASTNode::getChild(tiny::ASTNodeType t) const
+void tiny::ASTNode::addParam(const tiny::Parameter& p)
 {
-    for (const auto& c: children) {
-        if (c->type==t) {
-            return c;
+    if (tiny::isFlag(p.type)) {
+        if (p.val!=tiny::Value()) {
+            throw tiny::BadASTError("Parameters of type '" + p.toString() + "' can't hold a value", meta);
         }
+
+        flags |= flagOf(p.type);
+        return;
     }
 
-    throw tiny::NoSuchChild("Node of type '" + tiny::ASTNode(meta, t).toString() + "' expected but not found", meta);
+    if (param.type!=tiny::ParameterType::None && param.type!=p.type) {
+        throw tiny::BadASTError("A node can only hold one parameter with a value", meta);
+    }
+
+    param = p;
 }
 
-void tiny::ASTNode::addChildren(const tiny::ASTNode& c)
+tiny::NodeRef tiny::ASTArena::add(tiny::ASTNode node)
 {
-    children.push_back(std::make_shared<tiny::ASTNode>(c));
+    nodes.push_back(std::move(node));
+    return tiny::NodeRef(this, tiny::NodeId(nodes.size()-1));
 }
 
-void tiny::ASTNode::addChildren(const tiny::StatementList& cs)
+void tiny::ASTArena::addChild(tiny::NodeId parent, tiny::NodeId child)
 {
-    for (auto& n: cs) {
-        children.push_back(std::make_shared<tiny::ASTNode>(n));
+    auto& p = nodes[parent];
+    if (p.lastChild==tiny::NO_NODE) {
+        p.firstChild = child;
     }
+    else {
+        nodes[p.lastChild].nextSibling = child;
+    }
+
+    p.lastChild = child;
+}
+
+tiny::NodeId tiny::ASTArena::getChild(tiny::NodeId parent, tiny::ASTNodeType t) const
+{
+    for (auto c = nodes[parent].firstChild; c!=tiny::NO_NODE; c = nodes[c].nextSibling) {
+        if (nodes[c].type==t) {
+            return c;
+        }
+    }
+
+    auto const& meta = nodes[parent].meta;
+    throw tiny::NoSuchChild("Node of type '" + tiny::ASTNode(meta, t).toString() + "' expected but not found", meta);
 }
 
-std::shared_ptr<tiny::ASTNode> tiny::ASTNode::getFirstChild() const
+tiny::NodeId tiny::ASTArena::getFirstChild(tiny::NodeId parent) const
 {
-    if (children.empty()) {
-        throw tiny::NoSuchChild("Tried to get the left-most child, but the node has no children", meta);
+    auto const& node = nodes[parent];
+    if (node.firstChild==tiny::NO_NODE) {
+        throw tiny::NoSuchChild("Tried to get the left-most child, but the node has no children", node.meta);
     }
 
-    return children[0];
+    return node.firstChild;
 }
 
-std::shared_ptr<tiny::ASTNode> tiny::ASTNode::getSecondChild() const
+tiny::NodeId tiny::ASTArena::getSecondChild(tiny::NodeId parent) const
 {
-    if (children.size()<2) {
-        throw tiny::NoSuchChild("Tried to get the right-most child, but it doesn't exist", meta);
+    auto const& node = nodes[parent];
+    if (node.firstChild==tiny::NO_NODE || nodes[node.firstChild].nextSibling==tiny::NO_NODE) {
+        throw tiny::NoSuchChild("Tried to get the right-most child, but it doesn't exist", node.meta);
     }
 
-    return children[1];
+    return nodes[node.firstChild].nextSibling;
 }
 
-void tiny::ASTFile::dumpJson(const std::filesystem::path& path) const
+void tiny::ASTFile::dumpJson(const std::filesystem::path& path, bool lines) const
 {
-    std::ofstream jsonOut;
-    jsonOut.open(path);
-    jsonOut << toJson().dump(4);
-    jsonOut.close();
+    tiny::JSONWriter writer(path, lines ? tiny::JSONLayout::Compact : tiny::JSONLayout::Pretty);
+    if (lines) {
+        writeJsonLines(writer);
+    } else {
+        writeJson(writer);
+    }
+
+    writer.flush();
 }
 
-tiny::String tiny::ASTNode::getStringVal() const {
-    if (!std::holds_alternative<tiny::String>(val)) {
+tiny::Symbol tiny::ASTNode::getStringVal() const {
+    if (!val.holds<tiny::Symbol>()) {
         throw tiny::NoSuchValue("Tried to get the string value of a node that didn't contain one", meta);
     }
 
-    return std::get<tiny::String>(val);
+    return val.get<tiny::Symbol>();
 }
 
 bool tiny::ASTNode::isOperation() const
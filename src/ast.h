@@ -2,6 +2,8 @@
 #define TINY_AST_H
 
 #include <cstdint>
+#include <limits>
+#include <type_traits>
 #include <utility>
 #include <variant>
 #include <optional>
@@ -9,25 +11,157 @@
 #include <deque>
 
 #include "unicode.h"
+#include "interner.h"
 
 #include "nlohmann/json.hpp"
 #include "metadata.h"
 #include "file.h"
 
 namespace tiny {
-    // Forward declaration
+    // Forward declarations
     struct ASTNode;
+    class ASTArena;
+    class JSONWriter;
+
+    //! Index of an ASTNode inside the ASTArena that holds it
+    using NodeId = std::uint32_t;
+
+    //! A NodeId that doesn't point to any node, like the end of a list of children
+    inline constexpr tiny::NodeId NO_NODE = std::numeric_limits<tiny::NodeId>::max();
 
     //! Alias for a vector of nodes
-    using StatementList = std::vector<tiny::ASTNode>;
+    using StatementList = std::vector<tiny::NodeId>;
 
-    //! Value is a variant that can hold any of a unicode string, an uint64, an int64, a long double or a boolean
-    using Value = std::variant<
-            tiny::String, // ID, string or char
-            std::int64_t,            // Integer
-            std::uint64_t,           // Unsigned integer
-            long double,             // Decimal
-            bool>;                   // Boolean
+    //! Index of a decimal inside the ASTArena that holds it
+    enum class DecimalId : std::uint32_t {};
+
+    /*!
+     * \brief A Value holds any of an interned string, an int64, an uint64, a decimal or a boolean
+     *
+     * A Value is a 16-byte tagged union. Every alternative is stored inline in its 8-byte payload except for decimals,
+     * which don't fit. Those are kept by the ASTArena of the node (see ASTArena::addDecimal), and the Value only holds
+     * their DecimalId. The default Value is the empty string.
+     */
+    class Value {
+    public:
+        //! The alternative held by a Value
+        enum class Kind : std::uint8_t {
+            //! An interned string, for IDs, strings and chars
+            Symbol,
+            //! An integer
+            Int,
+            //! An unsigned integer
+            UInt,
+            //! A decimal
+            Decimal,
+            //! A boolean
+            Bool,
+        };
+
+        //! Builds the empty string
+        Value() = default;
+
+        Value(tiny::Symbol sym) : kind(Kind::Symbol) { // NOLINT(google-explicit-constructor)
+            payload.symbol = sym.getId();
+        }
+
+        Value(std::int64_t i) : kind(Kind::Int) { // NOLINT(google-explicit-constructor)
+            payload.integer = i;
+        }
+
+        Value(std::uint64_t u) : kind(Kind::UInt) { // NOLINT(google-explicit-constructor)
+            payload.unsignedInteger = u;
+        }
+
+        Value(tiny::DecimalId d) : kind(Kind::Decimal) { // NOLINT(google-explicit-constructor)
+            payload.decimal = std::uint32_t(d);
+        }
+
+        Value(bool b) : kind(Kind::Bool) { // NOLINT(google-explicit-constructor)
+            payload.boolean = b;
+        }
+
+        /*!
+         * \brief Gets the alternative held by the Value
+         * \return The Kind of the held value
+         */
+        [[nodiscard]] Kind getKind() const {
+            return kind;
+        }
+
+        /*!
+         * \brief Checks whether the Value holds a given alternative
+         * \tparam T One of tiny::Symbol, std::int64_t, std::uint64_t, tiny::DecimalId or bool
+         * \return True if the held value is of type T
+         */
+        template<typename T>
+        [[nodiscard]] bool holds() const {
+            return kind == kindOf<T>();
+        }
+
+        /*!
+         * \brief Gets the held value
+         * \tparam T One of tiny::Symbol, std::int64_t, std::uint64_t, tiny::DecimalId or bool
+         * \return The held value. Throws std::bad_variant_access if it isn't of type T
+         */
+        template<typename T>
+        [[nodiscard]] T get() const {
+            if (!holds<T>()) {
+                throw std::bad_variant_access();
+            }
+
+            if constexpr (std::is_same_v<T, tiny::Symbol>) {
+                return tiny::Symbol::fromId(payload.symbol);
+            } else if constexpr (std::is_same_v<T, std::int64_t>) {
+                return payload.integer;
+            } else if constexpr (std::is_same_v<T, std::uint64_t>) {
+                return payload.unsignedInteger;
+            } else if constexpr (std::is_same_v<T, tiny::DecimalId>) {
+                return tiny::DecimalId(payload.decimal);
+            } else {
+                return payload.boolean;
+            }
+        }
+
+        //! Decimals compare by their DecimalId, as their digits are held by the ASTArena
+        [[nodiscard]] bool operator==(const tiny::Value &rhs) const;
+
+        [[nodiscard]] bool operator!=(const tiny::Value &rhs) const {
+            return !(*this == rhs);
+        }
+
+    private:
+        //! Gets the Kind that holds a type
+        template<typename T>
+        static constexpr Kind kindOf() {
+            if constexpr (std::is_same_v<T, tiny::Symbol>) {
+                return Kind::Symbol;
+            } else if constexpr (std::is_same_v<T, std::int64_t>) {
+                return Kind::Int;
+            } else if constexpr (std::is_same_v<T, std::uint64_t>) {
+                return Kind::UInt;
+            } else if constexpr (std::is_same_v<T, tiny::DecimalId>) {
+                return Kind::Decimal;
+            } else {
+                static_assert(std::is_same_v<T, bool>, "A Value can't hold this type");
+                return Kind::Bool;
+            }
+        }
+
+        //! The held value, as given by kind
+        union {
+            std::uint32_t symbol;
+            std::int64_t integer;
+            std::uint64_t unsignedInteger;
+            std::uint32_t decimal;
+            bool boolean;
+        } payload{};
+
+        //! Alternative held in the payload
+        Kind kind = Kind::Symbol;
+    };
+
+    static_assert(sizeof(tiny::Value) <= 16, "Values are stored in every ASTNode and must stay small");
 
     /*!
      * \brief Transforms a Value into a std::string
@@ -37,7 +171,8 @@ namespace tiny {
      * Transforms a Value into a std::string. If the value holds an UnicodeCodepoints the returned value is an UTF-8
      * encoded representation. If the held value is numeric the string transformation of the number is returned
      * (using std::to_string). Boolean values will return either "True" of "False" (first letter capitalized)
-     * given the case
+     * given the case. Decimals are held by an ASTArena, so they can only be transformed through ASTArena::toString,
+     * and std::bad_variant_access is thrown for them.
      */
     [[nodiscard]] std::string toString(tiny::Value val);
 
@@ -67,6 +202,24 @@ namespace tiny {
         ComputedAccess,
     };
 
+    /*!
+     * \brief Checks whether Parameters of a type are modifiers that never hold a value
+     * \param t The type of the Parameter
+     * \return True for the flag types, which ASTNode stores as a single bit
+     */
+    constexpr bool isFlag(tiny::ParameterType t) {
+        switch (t) {
+        case tiny::ParameterType::Const:
+        case tiny::ParameterType::Pointer:
+        case tiny::ParameterType::Dereference:
+        case tiny::ParameterType::ValueAt:
+        case tiny::ParameterType::ComputedAccess:
+            return true;
+        default:
+            return false;
+        }
+    }
+
     //! A Parameter holds the complementary information of an ASTNode
     struct Parameter {
         Parameter() = default;
@@ -103,11 +256,17 @@ namespace tiny {
         [[nodiscard]] nlohmann::json toJson() const;
 
         /*!
-         * \brief Gets the value as a tiny::String. Throws NoSuchValue if val doesn't contain a string
+         * \brief Writes the Parameter as a JSON object, with the same schema as toJson
+         * \param writer The writer
+         */
+        void writeJson(tiny::JSONWriter &writer) const;
+
+        /*!
+         * \brief Gets the value as a tiny::Symbol. Throws NoSuchValue if val doesn't contain a string
          * \param meta The metadata of the base node searching the parameter. Required for error reporting
-         * \return A tiny::String
+         * \return A tiny::Symbol
          */
-        [[nodiscard]] tiny::String getStringVal(const tiny::Metadata& meta) const;
+        [[nodiscard]] tiny::Symbol getStringVal(const tiny::Metadata& meta) const;
     };
 
     //! The type of a given ASTNode
@@ -268,7 +427,10 @@ namespace tiny {
      *
      * An ASTNode is a node inside an Abstract Syntax Tree. The node holds references to its children nodes, as well as
      * optional values associated to the node, such as parameters and a value. The node has a type indicating the
-     * operation that the node represents
+     * operation that the node represents.
+     *
+     * Nodes live inside an ASTArena, and reference their children by their NodeId as a linked list: the node points to
+     * its first and last children, and each child to its next sibling. They're walked and linked through a NodeRef.
      */
     struct ASTNode {
     public:
@@ -281,31 +443,6 @@ namespace tiny {
          */
         explicit ASTNode(tiny::Metadata meta, tiny::ASTNodeType t) :type(t), meta(std::move(meta)) {};
 
-        /*!
-         * \brief Constructs a node withe the given type and one child
-         * \param t Type of the node
-         * \param c1 Child
-         */
-        explicit ASTNode(tiny::Metadata meta, tiny::ASTNodeType t, const tiny::ASTNode &c1);
-
-        /*!
-         * \brief Constructs a node withe the given type and two children
-         * \param t Type of the node
-         * \param c1 Child 1
-         * \param c2 Child 2
-         */
-        explicit ASTNode(tiny::Metadata meta, tiny::ASTNodeType t, const tiny::ASTNode &c1, const tiny::ASTNode &c2);
-
-        /*!
-         * \brief Constructs a node withe the given type and three children
-         * \param t Type of the node
-         * \param c1 Child 1
-         * \param c2 Child 2
-         * \param c3 Child 3
-         */
-        explicit ASTNode(tiny::Metadata meta, tiny::ASTNodeType t, const tiny::ASTNode &c1,
-                const tiny::ASTNode &c2, const tiny::ASTNode &c3);
-
         /*!
          * \brief Constructs a node withe the given type and value
          * \param t Type of the node
@@ -317,37 +454,43 @@ namespace tiny {
 
         //! The type of the node. Defaults to None
         tiny::ASTNodeType type = ASTNodeType::None;
-        //! A vector of Parameters for this node
-        std::vector<tiny::Parameter> params;
-        //! A vector of the children of this node
-        std::vector<std::shared_ptr<tiny::ASTNode>> children; // TODO Perhaps use just the object to avoid memory fragmentation?
+        //! The flag Parameters of this node (see isFlag), as a bitset with one bit per ParameterType
+        std::uint16_t flags = 0;
+        //! The Parameter of this node that holds a value. Nodes hold at most one, and its type is None if there's none
+        tiny::Parameter param;
         //! Metadata relating to this node
         tiny::Metadata meta;
         //! The optional value held by this node
         tiny::Value val;
 
+        //! The first child of this node, or NO_NODE if it has none
+        tiny::NodeId firstChild = tiny::NO_NODE;
+        //! The last child of this node, or NO_NODE if it has none
+        tiny::NodeId lastChild = tiny::NO_NODE;
+        //! The next child of this node's parent, or NO_NODE if it's the last one
+        tiny::NodeId nextSibling = tiny::NO_NODE;
+
         /*!
          * \brief Serializes the node as a string descriptor, containing basic information about the node
          * \return A std::string with minimal basic about the node
          */
         [[nodiscard]] std::string toString() const;
 
-        /*!
-         * \brief Serializes the node as a JSON object and recursively serializes its children
-         * \return A nlohmann::json with the data of the ASTNode and its descendants
-         */
-        [[nodiscard]] nlohmann::json toJson() const;
-
         /*!
          * \brief Fetches a Parameter by type
          * \param t Type of the Parameter to search for
          * \return The Parameter, if found
          *
-         * Fetches a Parameter by type. If more than one Parameter of a given type is present, the behaviour is undefined.
-         * Throws NoSuchParameter if the parameter doesn't exist.
+         * Fetches a Parameter by type in constant time. Throws NoSuchParameter if the parameter doesn't exist.
          */
         [[nodiscard]] tiny::Parameter getParam(tiny::ParameterType t) const;
 
+        /*!
+         * \brief Gets all the Parameters of the node
+         * \return A vector with the Parameters, ordered by their ParameterType
+         */
+        [[nodiscard]] std::vector<tiny::Parameter> getParams() const;
+
         /*!
          * \brief Returns whether the node contains a parameter of matching type
          * \param t Type of the Parameter to search for
@@ -358,63 +501,396 @@ namespace tiny {
         /*!
          * \brief Adds a parameter to the node
          * \param p Parameter to add
+         *
+         * Flag Parameters (see isFlag) are only recorded as a bit, and throw BadASTError if they hold a value. A node
+         * can hold a single Parameter of any other type, even if its value is empty; adding a second one of a
+         * different type throws BadASTError.
          */
         void addParam(const tiny::Parameter &p);
 
+        /*!
+         * \brief Fetches the tiny::Symbol from the value
+         * \return The string held by the node
+         *
+         * Fetches the tiny::Symbol from the value. Throws if no such child exists. Fails if the value doesn't contain a string
+         */
+        [[nodiscard]] tiny::Symbol getStringVal() const;
+
+        /*!
+         * \brief Returns whether the node's type is an operation
+         * \return True if the node's type is an operation, false otherwise
+         */
+        [[nodiscard]] bool isOperation() const;
+    };
+
+    /*!
+     * \brief A handle to an ASTNode inside an ASTArena
+     * \tparam Arena ASTArena, or const ASTArena for a read-only handle (ConstNodeRef)
+     *
+     * A NodeRef is the pair of an arena and the NodeId of a node inside it. It's cheap to copy, and it stays valid
+     * while the arena lives, even if more nodes are added to it. The node itself is reached with the -> operator; a
+     * reference to it is only valid until the next node is added to the arena.
+     */
+    template<typename Arena>
+    class BasicNodeRef {
+    public:
+        //! Iterates over the children of a node
+        class Iterator {
+        public:
+            explicit Iterator(Arena *a, tiny::NodeId i) : arena(a), id(i) {};
+
+            BasicNodeRef operator*() const {
+                return BasicNodeRef(arena, id);
+            }
+
+            Iterator &operator++() {
+                id = (*arena)[id].nextSibling;
+                return *this;
+            }
+
+            bool operator==(const Iterator &rhs) const {
+                return id == rhs.id;
+            }
+
+            bool operator!=(const Iterator &rhs) const {
+                return id != rhs.id;
+            }
+
+        private:
+            //! Arena of the children
+            Arena *arena;
+            //! Current child
+            tiny::NodeId id;
+        };
+
+        //! The children of a node, as a range usable in a for loop
+        struct Children {
+            //! Arena of the children
+            Arena *arena = nullptr;
+            //! First child of the node
+            tiny::NodeId first = tiny::NO_NODE;
+
+            [[nodiscard]] Iterator begin() const {
+                return Iterator(arena, first);
+            }
+
+            [[nodiscard]] Iterator end() const {
+                return Iterator(arena, tiny::NO_NODE);
+            }
+
+            [[nodiscard]] bool empty() const {
+                return first == tiny::NO_NODE;
+            }
+        };
+
+        //! Builds a handle that points to no node
+        BasicNodeRef() = default;
+
+        /*!
+         * \brief Builds a handle to a node
+         * \param a The arena that holds the node
+         * \param i The id of the node inside the arena
+         */
+        explicit BasicNodeRef(Arena *a, tiny::NodeId i) : arena(a), id(i) {};
+
+        /*!
+         * \brief Converts a NodeRef into a ConstNodeRef
+         * \param other The handle to convert
+         */
+        template<typename Other>
+        BasicNodeRef(const BasicNodeRef<Other> &other) : arena(other.getArena()), id(other.getId()) {}; // NOLINT
+
+        auto *operator->() const {
+            return &(*arena)[id];
+        }
+
+        auto &operator*() const {
+            return (*arena)[id];
+        }
+
+        //! Whether the handle points to a node
+        explicit operator bool() const {
+            return arena != nullptr && id != tiny::NO_NODE;
+        }
+
+        /*!
+         * \brief Gets the id of the node
+         * \return The NodeId of the node inside its arena
+         */
+        [[nodiscard]] tiny::NodeId getId() const {
+            return id;
+        }
+
+        /*!
+         * \brief Gets the arena that holds the node
+         * \return A pointer to the arena
+         */
+        [[nodiscard]] Arena *getArena() const {
+            return arena;
+        }
+
+        /*!
+         * \brief Gets the children of the node
+         * \return A range over the children, in order
+         */
+        [[nodiscard]] Children children() const {
+            return Children{arena, (*arena)[id].firstChild};
+        }
+
         /*!
          * \brief Fetches a child node by type and throws if no such children exists
-         * \param meta Metadata of the current context
          * \param t Type of the ASTNode to search for
-         * \return An ASTNode shared pointer
+         * \return A handle to the child
          *
          * Fetches a child node by type. If more than one node of a given type is present, the behaviour is undefined.
-         * Throws if no such child exists.
+         * Throws NoSuchChild if no such child exists.
          */
-        [[nodiscard]] std::shared_ptr<tiny::ASTNode> getChild(tiny::ASTNodeType t) const;
+        [[nodiscard]] BasicNodeRef getChild(tiny::ASTNodeType t) const {
+            return BasicNodeRef(arena, arena->getChild(id, t));
+        }
 
         /*!
          * \brief Fetches the first-most node, and throws if it doesn't exist
-         * \param meta Metadata of the current context
-         * \return An ASTNode shared pointer
+         * \return A handle to the child
          *
-         * Fetches the first-most child. Throws if no such child exists.
+         * Fetches the first-most child. Throws NoSuchChild if no such child exists.
          */
-        [[nodiscard]] std::shared_ptr<tiny::ASTNode> getFirstChild() const;
+        [[nodiscard]] BasicNodeRef getFirstChild() const {
+            return BasicNodeRef(arena, arena->getFirstChild(id));
+        }
 
         /*!
          * \brief Fetches the second-most node, and throws if it doesn't exist
-         * \param meta Metadata of the current context
-         * \return An ASTNode shared pointer
+         * \return A handle to the child
          *
-         * Fetches the second-most child. Throws if no such child exists.
+         * Fetches the second-most child. Throws NoSuchChild if no such child exists.
+         */
+        [[nodiscard]] BasicNodeRef getSecondChild() const {
+            return BasicNodeRef(arena, arena->getSecondChild(id));
+        }
+
+        /*!
+         * \brief Gets the node that follows this one under the same parent
+         * \return A handle to the sibling, which points to no node if this is the last child
          */
-        [[nodiscard]] std::shared_ptr<tiny::ASTNode> getSecondChild() const;
+        [[nodiscard]] BasicNodeRef getNextSibling() const {
+            return BasicNodeRef(arena, (*arena)[id].nextSibling);
+        }
 
         /*!
-         * \brief Adds a children node
-         * \param c ASTNode to add
+         * \brief Adds a children node. The child is linked, not copied
+         * \param c Node to add. It must belong to the same arena and have no parent
          */
-        void addChildren(const tiny::ASTNode &c);
+        void addChildren(const BasicNodeRef &c) const {
+            arena->addChild(id, c.getId());
+        }
 
         /*!
          * \brief Adds all the node in the list as children
-         * \param cs ASTNodes to add
+         * \param cs Nodes to add
          */
-        void addChildren(const tiny::StatementList &cs);
+        void addChildren(const tiny::StatementList &cs) const {
+            for (auto c: cs) {
+                arena->addChild(id, c);
+            }
+        }
 
         /*!
-         * \brief Fetches the tiny::String from the value
-         * \return The string held by the node
+         * \brief Adds a parameter to the node
+         * \param p Parameter to add
          *
-         * Fetches the tiny::String from the value. Throws if no such child exists. Fails if the value doesn't contain a string
+         * Same as ASTNode::addParam, but the node is only fetched once the parameter is built, so the parameter can be
+         * built from newly added nodes.
          */
-        [[nodiscard]] tiny::String getStringVal() const;
+        void addParam(const tiny::Parameter &p) const {
+            (*arena)[id].addParam(p);
+        }
 
         /*!
-         * \brief Returns whether the node's type is an operation
-         * \return True if the node's type is an operation, false otherwise
+         * \brief Serializes the node as a JSON object and recursively serializes its children
+         * \return A nlohmann::json with the data of the ASTNode and its descendants
          */
-        [[nodiscard]] bool isOperation() const;
+        [[nodiscard]] nlohmann::json toJson() const {
+            return arena->toJson(id);
+        }
+
+    private:
+        //! Arena that holds the node
+        Arena *arena = nullptr;
+        //! Id of the node inside the arena
+        tiny::NodeId id = tiny::NO_NODE;
+    };
+
+    //! A handle to a node that can be modified, and to which children can be added
+    using NodeRef = tiny::BasicNodeRef<tiny::ASTArena>;
+
+    //! A read-only handle to a node
+    using ConstNodeRef = tiny::BasicNodeRef<const tiny::ASTArena>;
+
+    /*!
+     * \brief An ASTArena holds all the nodes of an Abstract Syntax Tree
+     *
+     * An ASTArena stores the nodes of a file contiguously, and nodes reference each other by their NodeId (their index
+     * in the arena). Building a tree only links nodes together, so subtrees are never copied, and the whole tree is
+     * freed at once with the arena. Nodes can't be removed, but nodes that were never linked are harmless. Arenas can
+     * only be moved, so that a whole tree is never copied by accident.
+     */
+    class ASTArena {
+    public:
+        ASTArena() = default;
+        ASTArena(const ASTArena &) = delete;
+        ASTArena &operator=(const ASTArena &) = delete;
+        ASTArena(ASTArena &&) = default;
+        ASTArena &operator=(ASTArena &&) = default;
+
+        /*!
+         * \brief Moves a node into the arena
+         * \param node The node. It must have no children yet
+         * \return A handle to the node
+         */
+        tiny::NodeRef add(tiny::ASTNode node);
+
+        /*!
+         * \brief Gets a handle to a node
+         * \param id The id of the node
+         * \return A handle to the node
+         */
+        [[nodiscard]] tiny::NodeRef get(tiny::NodeId id) {
+            return tiny::NodeRef(this, id);
+        }
+
+        /*!
+         * \brief Gets a read-only handle to a node
+         * \param id The id of the node
+         * \return A handle to the node
+         */
+        [[nodiscard]] tiny::ConstNodeRef get(tiny::NodeId id) const {
+            return tiny::ConstNodeRef(this, id);
+        }
+
+        tiny::ASTNode &operator[](tiny::NodeId id) {
+            return nodes[id];
+        }
+
+        const tiny::ASTNode &operator[](tiny::NodeId id) const {
+            return nodes[id];
+        }
+
+        /*!
+         * \brief Links a node as the last child of another one
+         * \param parent The id of the parent
+         * \param child The id of the child. It must have no parent
+         */
+        void addChild(tiny::NodeId parent, tiny::NodeId child);
+
+        /*!
+         * \brief Fetches a child node by type and throws NoSuchChild if no such children exists
+         * \param parent The id of the parent
+         * \param t Type of the ASTNode to search for
+         * \return The id of the child
+         */
+        [[nodiscard]] tiny::NodeId getChild(tiny::NodeId parent, tiny::ASTNodeType t) const;
+
+        /*!
+         * \brief Fetches the first-most child of a node, and throws NoSuchChild if it doesn't exist
+         * \param parent The id of the parent
+         * \return The id of the child
+         */
+        [[nodiscard]] tiny::NodeId getFirstChild(tiny::NodeId parent) const;
+
+        /*!
+         * \brief Fetches the second-most child of a node, and throws NoSuchChild if it doesn't exist
+         * \param parent The id of the parent
+         * \return The id of the child
+         */
+        [[nodiscard]] tiny::NodeId getSecondChild(tiny::NodeId parent) const;
+
+        /*!
+         * \brief Visits a node and its descendants in depth-first order, without recursion
+         * \param root The id of the first node to visit
+         * \param enter Called with the id of a node before its children. Its children are skipped if it returns false
+         * \param leave Called with the id of a node after its children, only if they weren't skipped
+         *
+         * The pending nodes are kept on an explicit stack, so the depth of the tree is only limited by memory.
+         */
+        template<typename Enter, typename Leave>
+        void walk(tiny::NodeId root, Enter &&enter, Leave &&leave) const {
+            // Each entry holds a node and its next child to be visited
+            std::vector<std::pair<tiny::NodeId, tiny::NodeId>> stack;
+            if (enter(root)) {
+                stack.emplace_back(root, nodes[root].firstChild);
+            }
+
+            while (!stack.empty()) {
+                auto &[id, next] = stack.back();
+                if (next == tiny::NO_NODE) {
+                    auto done = id;
+                    stack.pop_back();
+                    leave(done);
+                    continue;
+                }
+
+                auto child = next;
+                next = nodes[child].nextSibling;
+                if (enter(child)) {
+                    stack.emplace_back(child, nodes[child].firstChild);
+                }
+            }
+        }
+
+        /*!
+         * \brief Serializes a node as a JSON object along with its descendants
+         * \param id The id of the node
+         * \return A nlohmann::json with the data of the ASTNode and its descendants
+         */
+        [[nodiscard]] nlohmann::json toJson(tiny::NodeId id) const;
+
+        /*!
+         * \brief Writes a node and its descendants as a JSON object, with the same schema as toJson
+         * \param id The id of the node
+         * \param writer The writer
+         */
+        void writeJson(tiny::NodeId id, tiny::JSONWriter &writer) const;
+
+        /*!
+         * \brief Stores a decimal in the arena, so that nodes can hold it as a Value
+         * \param d The decimal
+         * \return The id of the decimal inside the arena
+         */
+        tiny::DecimalId addDecimal(long double d) {
+            decimals.push_back(d);
+            return tiny::DecimalId(decimals.size() - 1);
+        }
+
+        /*!
+         * \brief Gets a decimal stored by addDecimal
+         * \param id The id of the decimal
+         * \return The decimal
+         */
+        [[nodiscard]] long double getDecimal(tiny::DecimalId id) const {
+            return decimals[std::size_t(id)];
+        }
+
+        /*!
+         * \brief Transforms a Value held by a node of the arena into a std::string
+         * \param val The value
+         * \return The same as tiny::toString, but also transforms decimals
+         */
+        [[nodiscard]] std::string toString(const tiny::Value &val) const;
+
+        /*!
+         * \brief Gets the number of nodes in the arena
+         * \return The number of nodes, linked or not
+         */
+        [[nodiscard]] std::size_t size() const {
+            return nodes.size();
+        }
+
+    private:
+        //! The nodes, indexed by their NodeId
+        std::vector<tiny::ASTNode> nodes;
+        //! The decimals held by the nodes, indexed by their DecimalId
+        std::vector<long double> decimals;
     };
 
     //! An Import holds information on an individual import call such as the name of the module and its optional alias.
@@ -425,25 +901,64 @@ namespace tiny {
          * \brief Creates a standard (non-aliased) import with the name of the module
          * \param modl Name of the module
          */
-        explicit Import(tiny::String modl) :mod(std::move(modl)) {};
+        explicit Import(tiny::Symbol modl) :mod(modl) {};
 
         /*!
          * \brief Creates an aliased import over the name of the module
          * \param modl Name of the module
          * \param als Alias of the imported module
          */
-        explicit Import(tiny::String modl, tiny::String als) :mod(std::move(modl)), alias(std::move(als)) {};
+        explicit Import(tiny::Symbol modl, tiny::Symbol als) :mod(modl), alias(als) {};
 
         //! Name of the module getting imported
-        tiny::String mod;
+        tiny::Symbol mod;
         //! Optional alias for the import
-        tiny::String alias;
+        tiny::Symbol alias;
 
         /*!
          * \brief Serializes the Import as a JSON object
          * \return A nlohmann::json with the data of the Import
          */
         [[nodiscard]] nlohmann::json toJson() const;
+
+        /*!
+         * \brief Writes the Import as a JSON object, with the same schema as toJson
+         * \param writer The writer
+         */
+        void writeJson(tiny::JSONWriter &writer) const;
+    };
+
+    //! A Comment is a comment found in a Tiny file. They're only kept for the consumers that ask for them
+    struct Comment {
+        explicit Comment() = default;
+
+        /*!
+         * \brief Creates a comment
+         * \param txt Text of the comment, without its delimiters
+         * \param ml Whether it's a multiline comment
+         * \param md Metadata of the comment
+         */
+        explicit Comment(std::string txt, bool ml, tiny::Metadata md) :text(std::move(txt)), multiline(ml),
+                                                                         meta(std::move(md)) {};
+
+        //! Text of the comment, without its delimiters
+        std::string text;
+        //! Whether it's a multiline comment
+        bool multiline = false;
+        //! Metadata of the comment
+        tiny::Metadata meta;
+
+        /*!
+         * \brief Serializes the Comment as a JSON object
+         * \return A nlohmann::json with the data of the Comment
+         */
+        [[nodiscard]] nlohmann::json toJson() const;
+
+        /*!
+         * \brief Writes the Comment as a JSON object, with the same schema as toJson
+         * \param writer The writer
+         */
+        void writeJson(tiny::JSONWriter &writer) const;
     };
 
     /*!
@@ -461,25 +976,32 @@ namespace tiny {
          * \param fn Filename
          * \param modl Module name
          * \param imprts Vector lisitng the imported modules
-         * \param stmts Vector of the AST roots
+         * \param nds Arena with the nodes of the AST
+         * \param stmts Vector of the AST roots inside the arena
          */
         explicit ASTFile(tiny::File fn,
-                         tiny::String modl,
+                         tiny::Symbol modl,
                          std::vector<tiny::Import> imprts,
+                         tiny::ASTArena nds,
                          tiny::StatementList stmts) :
                 file(fn),
-                mod(std::move(modl)),
+                mod(modl),
                 imports(std::move(imprts)),
+                nodes(std::move(nds)),
                 statements(std::move(stmts)) {};
 
         //! File that generated this AST
         tiny::File file;
         //! Name of the module which the file is a part of
-        tiny::String mod;
+        tiny::Symbol mod;
         //! Imports called by the code in the file
         std::vector<tiny::Import> imports;
-        //! The AST
+        //! The nodes of the AST
+        tiny::ASTArena nodes;
+        //! The AST, as the ids of its roots inside nodes
         tiny::StatementList statements;
+        //! Comments of the file, in source order. Empty unless they were asked for
+        std::vector<tiny::Comment> comments;
 
         /*!
          * \brief Serializes the file into a JSON object
@@ -487,12 +1009,31 @@ namespace tiny {
          */
         [[nodiscard]] nlohmann::json toJson() const;
 
+        /*!
+         * \brief Writes the file as a single JSON object, with the same schema as toJson
+         * \param writer The writer
+         */
+        void writeJson(tiny::JSONWriter &writer) const;
+
+        /*!
+         * \brief Writes the file as newline-delimited JSON, one line per statement
+         * \param writer The writer
+         *
+         * The first line holds the object of toJson without the statements, and each of the following lines holds
+         * the object of one statement, in order.
+         */
+        void writeJsonLines(tiny::JSONWriter &writer) const;
+
         /*!
          * \brief Creates a JSON dump of the AST
          * \param path Where to create the file
-         * \return A nlohmann::json with the data of the Parameter
+         * \param lines Whether to write compact newline-delimited JSON (see writeJsonLines) instead of an indented
+         * document
+         *
+         * The JSON is streamed into the file while the AST is traversed, so no document is built in memory. Throws
+         * FileError if the file can't be opened or written.
          */
-        void dumpJson(const std::filesystem::path &path) const;
+        void dumpJson(const std::filesystem::path &path, bool lines = false) const;
     };
 }
 
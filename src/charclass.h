@@ -0,0 +1,127 @@
+#ifndef TINY_CHARCLASS_H
+#define TINY_CHARCLASS_H
+
+#include <array>
+#include <cstdint>
+
+namespace tiny {
+    //! Classes a character can belong to, as bit flags of the entries of ASCII_CLASSES
+    struct CharClass {
+        //! Spaces and horizontal tabs
+        static constexpr std::uint8_t Blank = 1 << 0;
+
+        //! Decimal digits
+        static constexpr std::uint8_t Digit = 1 << 1;
+
+        //! Decimal digits and the letters A to F, in any case
+        static constexpr std::uint8_t HexDigit = 1 << 2;
+
+        //! Characters that can start an identifier
+        static constexpr std::uint8_t IdStart = 1 << 3;
+
+        //! Characters that can continue an identifier
+        static constexpr std::uint8_t IdContinue = 1 << 4;
+    };
+
+    //! A closed range of codepoints
+    struct CodepointRange {
+        //! First codepoint of the range
+        std::uint32_t first;
+
+        //! Last codepoint of the range
+        std::uint32_t last;
+    };
+
+    /*!
+     * \brief Builds the class of every ASCII character
+     * \return A table with the CharClass flags of every byte. Bytes over 0x7F have no class
+     */
+    constexpr std::array<std::uint8_t, 256> buildASCIIClasses() {
+        std::array<std::uint8_t, 256> classes{};
+
+        classes[' '] |= CharClass::Blank;
+        classes['\t'] |= CharClass::Blank;
+
+        for (char c = '0'; c <= '9'; c++) {
+            classes[c] |= CharClass::Digit | CharClass::HexDigit | CharClass::IdContinue;
+        }
+
+        for (char c = 'a'; c <= 'z'; c++) {
+            classes[c] |= CharClass::IdStart | CharClass::IdContinue;
+            classes[c - 'a' + 'A'] |= CharClass::IdStart | CharClass::IdContinue;
+        }
+
+        for (char c = 'a'; c <= 'f'; c++) {
+            classes[c] |= CharClass::HexDigit;
+            classes[c - 'a' + 'A'] |= CharClass::HexDigit;
+        }
+
+        classes['_'] |= CharClass::IdStart | CharClass::IdContinue;
+
+        return classes;
+    }
+
+    //! The CharClass flags of every ASCII character, built at compile time
+    inline constexpr std::array<std::uint8_t, 256> ASCII_CLASSES = buildASCIIClasses();
+
+    /*!
+     * \brief Checks whether a non-ASCII codepoint has the Unicode XID_Start property
+     * \param c The codepoint
+     * \return True if the codepoint can start an identifier
+     */
+    [[nodiscard]] bool isXIDStart(std::uint32_t c);
+
+    /*!
+     * \brief Checks whether a non-ASCII codepoint has the Unicode XID_Continue property
+     * \param c The codepoint
+     * \return True if the codepoint can continue an identifier
+     */
+    [[nodiscard]] bool isXIDContinue(std::uint32_t c);
+
+    /*!
+     * \brief Checks whether a codepoint is a space or a horizontal tab
+     * \param c The codepoint
+     * \return True if the codepoint is blank
+     */
+    [[nodiscard]] inline bool isBlank(std::uint32_t c) {
+        return c < 0x80 && (ASCII_CLASSES[c] & CharClass::Blank);
+    }
+
+    /*!
+     * \brief Checks whether a codepoint is an ASCII decimal digit
+     * \param c The codepoint
+     * \return True if the codepoint is a digit
+     */
+    [[nodiscard]] inline bool isDigit(std::uint32_t c) {
+        return c < 0x80 && (ASCII_CLASSES[c] & CharClass::Digit);
+    }
+
+    /*!
+     * \brief Checks whether a codepoint is an ASCII hexadecimal digit
+     * \param c The codepoint
+     * \return True if the codepoint is a hexadecimal digit
+     */
+    [[nodiscard]] inline bool isHexDigit(std::uint32_t c) {
+        return c < 0x80 && (ASCII_CLASSES[c] & CharClass::HexDigit);
+    }
+
+    /*!
+     * \brief Checks whether a codepoint can start an identifier
+     * \param c The codepoint
+     * \return True for ASCII letters, the underscore and codepoints with the XID_Start property
+     */
+    [[nodiscard]] inline bool isIdStart(std::uint32_t c) {
+        return c < 0x80 ? (ASCII_CLASSES[c] & CharClass::IdStart) != 0 : isXIDStart(c);
+    }
+
+    /*!
+     * \brief Checks whether a codepoint can continue an identifier
+     * \param c The codepoint
+     * \return True for ASCII letters and digits, the underscore and codepoints with the XID_Continue property
+     */
+    [[nodiscard]] inline bool isIdContinue(std::uint32_t c) {
+        return c < 0x80 ? (ASCII_CLASSES[c] & CharClass::IdContinue) != 0 : isXIDContinue(c);
+    }
+}
+
+#endif //TINY_CHARCLASS_H
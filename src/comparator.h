@@ -5,18 +5,19 @@
 #include <tuple>
 
 #include "stream.h"
+#include "source.h"
 
 namespace tiny {
-    //! The underlying type of the Stream and the sequences.
-    template<typename T>
-    //! A StreamComparator helps to compare a Stream to an array of values.
+    //! The underlying type of the Stream and the sequences, and the type of the stream itself.
+    template<typename T, typename S = tiny::Stream<T>>
+    //! A StreamComparator helps to compare a Stream (or any type with the same interface) to an array of values.
     class StreamComparator {
     public:
         /*!
          * \brief Create a comparator from a Stream
          * \param stream Stream to compare to
          */
-        explicit StreamComparator(tiny::Stream<T> &stream) : s(stream) {};
+        explicit StreamComparator(S &stream) : s(stream) {};
 
         /*!
          * \brief Compares the sequence with the stream
@@ -103,7 +104,7 @@ namespace tiny {
          * returned. The return value is packed as a std::pair<std::vector<T>, Result>
          */
         [[nodiscard]] std::pair<std::vector<T>, Result>
-        matchCase(std::map<std::vector<T>, Result> cases, Result def = Result{}) {
+        matchCase(const std::map<std::vector<T>, Result> &cases, Result def = Result{}) {
             std::int32_t maxLength = 0;
             for (auto const&[seq, _]: cases) {
                 if (seq.size() > maxLength) {
@@ -145,7 +146,7 @@ namespace tiny {
          * value is provided it will be returned when no case matches. If no default value is provided the
          * zero-value of the type will be returned.
          */
-        [[nodiscard]] Result matchPeek(std::map<std::vector<T>, Result> cases, Result def = Result{}) {
+        [[nodiscard]] Result matchPeek(const std::map<std::vector<T>, Result> &cases, Result def = Result{}) {
             return matchCase(cases, def).second;
         }
 
@@ -162,7 +163,7 @@ namespace tiny {
          * default (def) value is provided I'll be returned when no case matches. If no default value is provided
          * the zero-value of the type will be returned.
          */
-        [[nodiscard]] Result match(std::map<std::vector<T>, Result> cases, Result def = Result{}) {
+        [[nodiscard]] Result match(const std::map<std::vector<T>, Result> &cases, Result def = Result{}) {
             auto matched = matchCase(cases, def);
             s.advance(std::get<0>(matched).size());
 
@@ -171,8 +172,15 @@ namespace tiny {
 
     private:
         //! Stream to compare
-        Stream <T> &s;
+        S &s;
     };
+
+    //! Deduce the value type from the Stream
+    template<typename T>
+    StreamComparator(tiny::Stream<T> &) -> StreamComparator<T>;
+
+    //! A SourceStream yields codepoints
+    StreamComparator(tiny::SourceStream &) -> StreamComparator<std::uint32_t, tiny::SourceStream>;
 }
 
 #endif //TINY_COMPARATOR_H
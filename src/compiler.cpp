@@ -62,63 +62,93 @@ tiny::CompilationResult tiny::Compiler::compile() const {
 
         tiny::debug(f, "Running compiler..");
 
-        std::ifstream filestream(f.path);
-        tiny::Stream charStream(filestream);
-
-        tiny::Lexer lexer(charStream);
-        lexer.setMetadataFile(f);
-        std::vector<tiny::Lexeme> lexemes;
-
-        tiny::debug(f, "Lexing..");
+        // Map the file instead of reading it. The lexer decodes it as it goes.
+        tiny::FileId fileId;
+        try {
+            fileId = tiny::SourceManager::get().load(f);
+        } catch (const tiny::FileError &e) {
+            tiny::fatal(e.what());
+            return {tiny::CompilationStatus::Error, {tiny::CompilationStep::FileSelection, e.what()}};
+        }
 
-        /*
-         * Lexing stage
-         *
-         * Separate every file in lexemes that can be used to build the parse tree
-         */
+        tiny::Lexer lexer(tiny::SourceStream(tiny::SourceManager::get().getSource(fileId)));
+        lexer.setMetadataFile(fileId);
 
-        try {
-            lexemes = lexer.lexAll();
-        } catch (const tiny::LexError &e) {
-            tiny::error(e.what());
-            e.log(charStream);
-            tiny::fatal("Invalid program");
+        // Comments are only kept when asked for. Otherwise they're dropped as soon as they're found
+        bool keepTrivia = tiny::getSetting(tiny::Option::KeepTrivia).isEnabled;
+        lexer.setTriviaMode(keepTrivia ? tiny::TriviaMode::Collect : tiny::TriviaMode::Skip);
 
-            return {tiny::CompilationStatus::Error, {tiny::CompilationStep::Lexer, e.what()}};
-        }
+        // Lexing errors are gathered instead of thrown, so that all of them are reported in a single run
+        lexer.setErrorMode(tiny::ErrorMode::Recover);
 
         /*
         tiny::debug("Running lex pipe with length " + std::to_string(pl.getPipeLength(tiny::CompilationStep::Lexer)));
         lexemes = pl.runLexPipe(lexemes);
          */
 
-        tiny::Stream<tiny::Lexeme> lexemeStream(lexemes);
-        tiny::Parser parser(lexemeStream);
-
-        tiny::debug(f, "Parsing..");
+        tiny::debug(f, "Lexing and parsing..");
 
         /*
-         * Parse stage
+         * Lexing and parse stage
          *
-         * Use the lexemes to build an AST (Parse tree) that can represent the relationship between the lexemes
+         * Separate every file in lexemes that can be used to build the parse tree, and use them to build an AST (Parse
+         * tree) that can represent the relationship between the lexemes. The parser pulls the lexemes as it needs
+         * them, so both run at the same time. Files big enough to be worth splitting are lexed up-front on every core
+         * instead.
          */
 
         tiny::ASTFile astFile;
         try {
-            astFile = parser.file(f);
+            if (lexer.getSource().size() >= PARALLEL_LEXING_THRESHOLD) {
+                tiny::Parser parser(lexer.tokenizeParallel());
+                astFile = parser.file(f);
+            } else {
+                tiny::Parser parser(lexer);
+                astFile = parser.file(f);
+            }
         } catch (const tiny::ParseError &e) {
-            tiny::error(e.what());
-            e.log(charStream);
-            tiny::fatal("Invalid program");
+            // Parse errors are often caused by the tokens dropped by a lexing error, which are reported instead
+            if (lexer.getDiagnostics().empty()) {
+                tiny::error(e.what());
+                e.log();
+                tiny::fatal("Invalid program");
+
+                return {tiny::CompilationStatus::Error, {tiny::CompilationStep::Parser, e.what()}};
+            }
+        } catch (const std::exception &e) {
+            // Same as above, the lexing errors found so far are reported instead if there are any
+            if (lexer.getDiagnostics().empty()) {
+                tiny::error("Exception encountered while parsing");
+                tiny::error(e.what());
+                tiny::fatal("Invalid program");
+
+                return {tiny::CompilationStatus::Error, {tiny::CompilationStep::Parser, e.what()}};
+            }
+        }
 
-            return {tiny::CompilationStatus::Error, {tiny::CompilationStep::Parser, e.what()}};
+        if (!lexer.getDiagnostics().empty()) {
+            // The parser might have stopped early, so lex the rest of the file for its errors
+            try {
+                while (lexer) {
+                    (void) lexer.lex();
+                }
+            } catch (const std::exception &) {
+                // Only lexing errors are recovered from. The ones found so far are still reported
+            }
+
+            for (auto const &e: lexer.getDiagnostics()) {
+                tiny::error(e.what());
+                e.log();
+            }
 
-        } catch (const std::exception &e) {
-            tiny::error("Exception encountered while parsing");
-            tiny::error(e.what());
             tiny::fatal("Invalid program");
 
-            return {tiny::CompilationStatus::Error, {tiny::CompilationStep::Parser, e.what()}};
+            auto const &first = lexer.getDiagnostics().front();
+            return {tiny::CompilationStatus::Error, {tiny::CompilationStep::Lexer, first.what()}};
+        }
+
+        for (auto const &c: lexer.getTrivia()) {
+            astFile.comments.emplace_back(std::string(c.value), c.token == tiny::Token::MultilineComment, c.metadata);
         }
 
         /*
@@ -126,16 +156,26 @@ tiny::CompilationResult tiny::Compiler::compile() const {
         astFile = pl.runParsePipe(astFile);
          */
 
-        if (tiny::getSetting(tiny::Option::OutputASTJSON).isEnabled) {
-            astFile.dumpJson(f.path.filename().string() + ".ast.json");
+        try {
+            if (tiny::getSetting(tiny::Option::OutputASTJSON).isEnabled) {
+                astFile.dumpJson(f.path.filename().string() + ".ast.json");
+            }
+
+            if (tiny::getSetting(tiny::Option::OutputASTNDJSON).isEnabled) {
+                astFile.dumpJson(f.path.filename().string() + ".ast.ndjson", true);
+            }
+        } catch (const tiny::FileError &e) {
+            tiny::fatal(e.what());
+            return {tiny::CompilationStatus::Error, {tiny::CompilationStep::Parser, e.what()}};
         }
 
-        astFiles.push_back(astFile);
-
         tiny::debug(f, "Building symbol table..");
 
         tiny::SymbolTable symtab(astFile);
         symtab.build();
+
+        // The file owns all of its nodes, so it's moved to avoid a copy of the whole tree
+        astFiles.push_back(std::move(astFile));
     }
 
     std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
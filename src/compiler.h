@@ -72,6 +72,9 @@ namespace tiny {
         tiny::Pipeline pl = tiny::Pipeline();
         //! The file selector to choose which files should be targeted by the compiler
         tiny::FileSelector fileSelector{};
+
+        //! Size in bytes from which a file is lexed on every core before parsing, instead of as the parser goes
+        static constexpr std::size_t PARALLEL_LEXING_THRESHOLD = 1 << 20;
     };
 }
 
@@ -51,7 +51,7 @@ void tiny::Configuration::parseArguments(int argc, char *argv[])
         }
         case Option::Log: {
             auto levelStr = s.get();
-            static std::map<tiny::String, std::int32_t> levelTable {
+            static std::unordered_map<tiny::String, std::int32_t> levelTable {
                     {"debug", std::int32_t(tiny::LogLevel::Debug)},
                     {"info", std::int32_t(tiny::LogLevel::Info)},
                     {"warn", std::int32_t(tiny::LogLevel::Warning)},
@@ -75,6 +75,14 @@ void tiny::Configuration::parseArguments(int argc, char *argv[])
         case Option::OutputASTJSON:
             setSetting(tiny::Setting{Option::OutputASTJSON, true});
             break;
+
+        case Option::KeepTrivia:
+            setSetting(tiny::Setting{Option::KeepTrivia, true});
+            break;
+
+        case Option::OutputASTNDJSON:
+            setSetting(tiny::Setting{Option::OutputASTNDJSON, true});
+            break;
         }
     }
 }
@@ -4,6 +4,7 @@
 #include <utility>
 #include <variant>
 #include <map>
+#include <unordered_map>
 
 #include "unicode.h"
 #include "logger.h"
@@ -15,6 +16,8 @@ namespace tiny{
         PrintVersion,
         Log,
         OutputASTJSON,
+        KeepTrivia,
+        OutputASTNDJSON,
     };
 
     //! Holds the current state of a setting
@@ -58,6 +61,8 @@ namespace tiny{
                 {Option::PrintVersion, false},
                 {Option::Log, true, std::int32_t(tiny::LogLevel::Info)},
                 {Option::OutputASTJSON, false},
+                {Option::KeepTrivia, false},
+                {Option::OutputASTNDJSON, false},
         };
 
         //! Maps parameters to their respective option for use in argument parsing
@@ -65,6 +70,8 @@ namespace tiny{
                 {{"version"}, Option::PrintVersion},
                 {{"--log"}, Option::Log},
                 {{"--ast-json"}, Option::OutputASTJSON},
+                {{"--keep-trivia"}, Option::KeepTrivia},
+                {{"--ast-ndjson"}, Option::OutputASTNDJSON},
         };
     };
 
@@ -0,0 +1,310 @@
+#include "decoder.h"
+
+#include "errors.h"
+
+#if defined(TINY_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+namespace {
+    /*!
+     * \brief Decodes the multi-byte sequence starting at the given offset
+     * \param bytes The UTF-8 encoded bytes
+     * \param i The byte offset of the sequence. It's advanced past the sequence
+     * \return The decoded codepoint
+     *
+     * Throws DecodeError if the sequence is invalid, truncated, overlong, a surrogate or past the last plane.
+     */
+    std::uint32_t decodeSequence(std::string_view bytes, std::size_t &i) {
+        auto lead = static_cast<unsigned char>(bytes[i]);
+        std::uint32_t cp;
+        std::size_t length;
+        std::uint32_t min;
+
+        if (lead >= 0xc2 && lead <= 0xdf) {
+            cp = lead & 0x1f;
+            length = 2;
+            min = 0x80;
+        } else if (lead >= 0xe0 && lead <= 0xef) {
+            cp = lead & 0x0f;
+            length = 3;
+            min = 0x800;
+        } else if (lead >= 0xf0 && lead <= 0xf4) {
+            cp = lead & 0x07;
+            length = 4;
+            min = 0x10000;
+        } else {
+            throw tiny::DecodeError("Invalid UTF-8 lead byte", i);
+        }
+
+        if (i + length > bytes.size()) {
+            throw tiny::DecodeError("Truncated UTF-8 sequence", i);
+        }
+
+        for (std::size_t n = 1; n < length; n++) {
+            auto byte = static_cast<unsigned char>(bytes[i + n]);
+            if ((byte & 0xc0) != 0x80) {
+                throw tiny::DecodeError("Invalid UTF-8 continuation byte", i);
+            }
+
+            cp = (cp << 6) | (byte & 0x3f);
+        }
+
+        if (cp < min) {
+            throw tiny::DecodeError("Overlong UTF-8 sequence", i);
+        }
+
+        if ((cp >= 0xd800 && cp <= 0xdfff) || cp > 0x10ffff) {
+            throw tiny::DecodeError("Invalid UTF-8 codepoint", i);
+        }
+
+        i += length;
+        return cp;
+    }
+
+    /*!
+     * \brief Handles the byte at i, which is known not to be plain ASCII
+     * \param bytes The UTF-8 encoded bytes
+     * \param i The byte offset. It's advanced past the decoded sequence
+     * \param out Where the decoded codepoint is written
+     * \return False if the byte is a NUL and decoding should stop, true otherwise
+     */
+    bool decodeSlow(std::string_view bytes, std::size_t &i, std::uint32_t *&out) {
+        if (bytes[i] == '\0') {
+            return false;
+        }
+
+        *out++ = decodeSequence(bytes, i);
+        return true;
+    }
+
+    std::size_t decodeScalar(std::string_view bytes, std::uint32_t *&out) {
+        std::size_t i = 0;
+        while (i < bytes.size()) {
+            auto c = static_cast<unsigned char>(bytes[i]);
+            if (c != 0 && c < 0x80) {
+                *out++ = c;
+                i++;
+                continue;
+            }
+
+            if (!decodeSlow(bytes, i, out)) {
+                break;
+            }
+        }
+
+        return i;
+    }
+
+#if defined(TINY_SIMD_X86)
+    __attribute__((target("sse2")))
+    std::size_t scanSSE2(std::string_view bytes) {
+        const auto *data = reinterpret_cast<const unsigned char *>(bytes.data());
+        const __m128i zero = _mm_setzero_si128();
+
+        std::size_t i = 0;
+        for (; i + 16 <= bytes.size(); i += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(chunk) |
+                                              _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero)));
+
+            if (mask != 0) {
+                return i + static_cast<std::size_t>(__builtin_ctz(mask));
+            }
+        }
+
+        for (; i < bytes.size() && data[i] != 0 && data[i] < 0x80; i++);
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    std::size_t scanAVX2(std::string_view bytes) {
+        const auto *data = reinterpret_cast<const unsigned char *>(bytes.data());
+        const __m256i zero = _mm256_setzero_si256();
+
+        std::size_t i = 0;
+        for (; i + 32 <= bytes.size(); i += 32) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            auto mask = static_cast<unsigned>(_mm256_movemask_epi8(chunk) |
+                                              _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, zero)));
+
+            if (mask != 0) {
+                return i + static_cast<std::size_t>(__builtin_ctz(mask));
+            }
+        }
+
+        for (; i < bytes.size() && data[i] != 0 && data[i] < 0x80; i++);
+        return i;
+    }
+
+    __attribute__((target("sse2")))
+    std::size_t decodeSSE2(std::string_view bytes, std::uint32_t *&out) {
+        const auto *data = reinterpret_cast<const unsigned char *>(bytes.data());
+        const __m128i zero = _mm_setzero_si128();
+
+        std::size_t i = 0;
+        while (i < bytes.size()) {
+            if (i + 16 <= bytes.size()) {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+
+                // A set bit marks either a non-ASCII byte or a NUL
+                auto mask = static_cast<unsigned>(_mm_movemask_epi8(chunk) |
+                                                  _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero)));
+
+                if (mask == 0) {
+                    __m128i lo = _mm_unpacklo_epi8(chunk, zero);
+                    __m128i hi = _mm_unpackhi_epi8(chunk, zero);
+
+                    auto *dst = reinterpret_cast<__m128i *>(out);
+                    _mm_storeu_si128(dst, _mm_unpacklo_epi16(lo, zero));
+                    _mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(lo, zero));
+                    _mm_storeu_si128(dst + 2, _mm_unpacklo_epi16(hi, zero));
+                    _mm_storeu_si128(dst + 3, _mm_unpackhi_epi16(hi, zero));
+
+                    out += 16;
+                    i += 16;
+                    continue;
+                }
+
+                // Copy the ASCII prefix and fall through to the slow path for the flagged byte
+                auto ascii = static_cast<std::size_t>(__builtin_ctz(mask));
+                for (std::size_t n = 0; n < ascii; n++) {
+                    *out++ = data[i + n];
+                }
+
+                i += ascii;
+            } else if (data[i] != 0 && data[i] < 0x80) {
+                *out++ = data[i++];
+                continue;
+            }
+
+            if (!decodeSlow(bytes, i, out)) {
+                break;
+            }
+        }
+
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    std::size_t decodeAVX2(std::string_view bytes, std::uint32_t *&out) {
+        const auto *data = reinterpret_cast<const unsigned char *>(bytes.data());
+        const __m256i zero = _mm256_setzero_si256();
+
+        std::size_t i = 0;
+        while (i < bytes.size()) {
+            if (i + 32 <= bytes.size()) {
+                __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+
+                // A set bit marks either a non-ASCII byte or a NUL
+                auto mask = static_cast<unsigned>(_mm256_movemask_epi8(chunk) |
+                                                  _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, zero)));
+
+                if (mask == 0) {
+                    auto *dst = reinterpret_cast<__m256i *>(out);
+                    for (int n = 0; n < 4; n++) {
+                        __m128i eight = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(data + i + n * 8));
+                        _mm256_storeu_si256(dst + n, _mm256_cvtepu8_epi32(eight));
+                    }
+
+                    out += 32;
+                    i += 32;
+                    continue;
+                }
+
+                // Copy the ASCII prefix and fall through to the slow path for the flagged byte
+                auto ascii = static_cast<std::size_t>(__builtin_ctz(mask));
+                for (std::size_t n = 0; n < ascii; n++) {
+                    *out++ = data[i + n];
+                }
+
+                i += ascii;
+            } else if (data[i] != 0 && data[i] < 0x80) {
+                *out++ = data[i++];
+                continue;
+            }
+
+            if (!decodeSlow(bytes, i, out)) {
+                break;
+            }
+        }
+
+        return i;
+    }
+#endif
+}
+
+tiny::SIMDLevel tiny::getSIMDLevel() {
+#if defined(TINY_SIMD_X86)
+    static const tiny::SIMDLevel level = []() {
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2")) {
+            return tiny::SIMDLevel::AVX2;
+        }
+
+        if (__builtin_cpu_supports("sse2")) {
+            return tiny::SIMDLevel::SSE2;
+        }
+
+        return tiny::SIMDLevel::Scalar;
+    }();
+
+    return level;
+#else
+    return tiny::SIMDLevel::Scalar;
+#endif
+}
+
+std::size_t tiny::scanASCII(std::string_view bytes) {
+    switch (tiny::getSIMDLevel()) {
+#if defined(TINY_SIMD_X86)
+        case tiny::SIMDLevel::AVX2:
+            return scanAVX2(bytes);
+        case tiny::SIMDLevel::SSE2:
+            return scanSSE2(bytes);
+#endif
+        default: {
+            std::size_t i = 0;
+            for (; i < bytes.size() && bytes[i] != '\0' && static_cast<unsigned char>(bytes[i]) < 0x80; i++);
+            return i;
+        }
+    }
+}
+
+std::size_t tiny::decodeUTF8(std::string_view bytes, std::vector<std::uint32_t> &out) {
+    return tiny::decodeUTF8(bytes, out, tiny::getSIMDLevel());
+}
+
+std::size_t tiny::decodeUTF8(std::string_view bytes, std::vector<std::uint32_t> &out, tiny::SIMDLevel level) {
+    // There's never more codepoints than bytes. Size the output for the worst case and trim it afterwards.
+    std::size_t start = out.size();
+    out.resize(start + bytes.size());
+
+    std::uint32_t *begin = out.data() + start;
+    std::uint32_t *cursor = begin;
+    std::size_t consumed;
+
+    try {
+        switch (level) {
+#if defined(TINY_SIMD_X86)
+            case tiny::SIMDLevel::AVX2:
+                consumed = decodeAVX2(bytes, cursor);
+                break;
+            case tiny::SIMDLevel::SSE2:
+                consumed = decodeSSE2(bytes, cursor);
+                break;
+#endif
+            default:
+                consumed = decodeScalar(bytes, cursor);
+                break;
+        }
+    }
+    catch (const tiny::DecodeError &) {
+        out.resize(start);
+        throw;
+    }
+
+    out.resize(start + std::size_t(cursor - begin));
+    return consumed;
+}
@@ -0,0 +1,64 @@
+#ifndef TINY_DECODER_H
+#define TINY_DECODER_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+//! Set when the SSE2 and AVX2 paths can be compiled in and selected at runtime
+#define TINY_SIMD_X86
+#endif
+
+namespace tiny {
+    //! The vector instruction sets the decoder can use. Higher values are wider.
+    enum class SIMDLevel {
+        //! Plain byte-at-a-time code
+        Scalar,
+        //! 16 bytes per step
+        SSE2,
+        //! 32 bytes per step
+        AVX2,
+    };
+
+    /*!
+     * \brief Gets the widest instruction set supported by the running CPU
+     * \return The detected SIMDLevel. Detection only runs once
+     */
+    [[nodiscard]] tiny::SIMDLevel getSIMDLevel();
+
+    /*!
+     * \brief Measures the run of plain ASCII bytes at the start of a byte sequence
+     * \param bytes The bytes to scan
+     * \return The number of leading bytes that are ASCII and not NUL
+     *
+     * Uses the same vectorized paths as decodeUTF8. Any byte in the returned prefix is a valid, single-byte UTF-8
+     * sequence and can be copied as-is.
+     */
+    [[nodiscard]] std::size_t scanASCII(std::string_view bytes);
+
+    /*!
+     * \brief Validates a UTF-8 byte sequence and widens it into codepoints
+     * \param bytes The UTF-8 encoded bytes
+     * \param out The vector the codepoints are appended to
+     * \return The number of bytes consumed
+     *
+     * Validates a UTF-8 byte sequence and appends its codepoints to out. Runs of ASCII are validated and widened
+     * 16 (SSE2) or 32 (AVX2) bytes at a time, using the widest instruction set the CPU supports, and multi-byte
+     * sequences are decoded one at a time. Decoding stops at the first NUL byte, which is not appended.
+     *
+     * If an invalid or truncated sequence is found DecodeError is thrown with the byte offset of the sequence.
+     */
+    std::size_t decodeUTF8(std::string_view bytes, std::vector<std::uint32_t> &out);
+
+    /*!
+     * \brief Same as decodeUTF8, but forcing an instruction set
+     * \param bytes The UTF-8 encoded bytes
+     * \param out The vector the codepoints are appended to
+     * \param level The instruction set to use. Must be supported by the CPU
+     * \return The number of bytes consumed
+     */
+    std::size_t decodeUTF8(std::string_view bytes, std::vector<std::uint32_t> &out, tiny::SIMDLevel level);
+}
+
+#endif //TINY_DECODER_H
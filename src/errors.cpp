@@ -4,11 +4,11 @@
 
 #include <algorithm>
 
-void tiny::CompilerError::log(tiny::Stream<std::uint32_t> &s) const {
-    auto [line, col] = meta.getPosition(s);
-    auto [context, pos] = meta.getContext(s);
+void tiny::CompilerError::log() const {
+    auto [line, col] = meta.getPosition();
+    auto [context, pos] = meta.getContext();
 
-    tiny::error("In file \"" + meta.file.getRelativePath().string() + "\" in line " + std::to_string(line) +
+    tiny::error("In file \"" + meta.getFile().getRelativePath().string() + "\" in line " + std::to_string(line) +
             ", column " + std::to_string(col) + ": ");
 
     tiny::error("\t" + context);
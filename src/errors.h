@@ -33,10 +33,11 @@ namespace tiny {
         }
 
         /*!
-         * \brief Uses the error metadata to build a context around a stream and logs it to the Logger
-         * \param s The stream over which the error was found
+         * \brief Uses the error metadata to build a context around the error's file and logs it to the Logger
+         *
+         * The file's source is fetched from the SourceManager, so it must have been registered there.
          */
-        void log(tiny::Stream<std::uint32_t> &s) const;
+        void log() const;
     };
 
     //! Gets thrown by the lexer when a program can't be tokenized.
@@ -183,6 +184,34 @@ namespace tiny {
         using FileError::FileError; // Inherit the constructor
     };
 
+    //! Gets thrown when a byte sequence isn't valid UTF-8
+    struct DecodeError : public std::exception {
+        //! A message describing the error
+        std::string msg;
+
+        //! The message given on creation, without the offset
+        std::string reason;
+
+        //! Byte offset of the start of the invalid sequence
+        std::size_t offset = 0;
+
+        /*!
+         * \brief Creates a new DecodeError
+         * \param msg A message that describes the error
+         * \param offset Byte offset of the invalid sequence
+         */
+        explicit DecodeError(const std::string &msg, std::size_t offset) : msg(
+                msg + " at byte " + std::to_string(offset)), reason(msg), offset(offset) {};
+
+        /*!
+         * \brief Returns a C-string detailing the error
+         * \return A C-string with an explanation of the error
+         */
+        [[nodiscard]] const char *what() const noexcept override {
+            return msg.c_str();
+        }
+    };
+
     struct CLIError : public std::exception {
         //! A message describing the error
         std::string msg = "Command error";
@@ -0,0 +1,77 @@
+#include "interner.h"
+
+tiny::Interner::Interner() {
+    // Id 0 is reserved for the empty string, which is what default-constructed Symbols hold
+    intern("");
+}
+
+tiny::Interner::~Interner() {
+    for (auto &chunk: chunks) {
+        delete[] chunk.load();
+    }
+}
+
+std::pair<std::size_t, std::size_t> tiny::Interner::locate(std::uint32_t id) {
+    std::uint64_t n = std::uint64_t(id) + FIRST_CHUNK;
+
+    std::size_t bits = 0;
+    for (std::uint64_t v = n; v > 1; v >>= 1) {
+        bits++;
+    }
+
+    std::size_t chunk = bits - 10; // log2(FIRST_CHUNK)
+    return {chunk, std::size_t(n - (FIRST_CHUNK << chunk))};
+}
+
+std::uint32_t tiny::Interner::intern(std::string_view str) {
+    auto &shard = shards[std::hash<std::string_view>()(str) & (SHARD_COUNT - 1)];
+
+    {
+        std::shared_lock lock(shard.mutex);
+        if (auto found = shard.ids.find(str); found != shard.ids.end()) {
+            return found->second;
+        }
+    }
+
+    // Decode before taking the exclusive lock, so invalid strings throw without holding it
+    tiny::String decoded(str);
+
+    std::unique_lock lock(shard.mutex);
+    if (auto found = shard.ids.find(str); found != shard.ids.end()) {
+        return found->second; // Another thread interned it in the meantime
+    }
+
+    std::uint32_t id = nextId.fetch_add(1, std::memory_order_acq_rel);
+    auto [chunkIndex, offset] = locate(id);
+
+    Entry *chunk = chunks[chunkIndex].load(std::memory_order_acquire);
+    if (!chunk) {
+        std::lock_guard chunkLock(chunkMutex);
+
+        chunk = chunks[chunkIndex].load(std::memory_order_acquire);
+        if (!chunk) {
+            chunk = new Entry[FIRST_CHUNK << chunkIndex];
+            chunks[chunkIndex].store(chunk, std::memory_order_release);
+        }
+    }
+
+    chunk[offset].utf8 = std::string(str);
+    chunk[offset].str = std::move(decoded);
+
+    // The key views the entry's own copy of the bytes, which never moves
+    shard.ids.emplace(chunk[offset].utf8, id);
+
+    return id;
+}
+
+tiny::Symbol::Symbol(std::string_view str) : id(tiny::Interner::get().intern(str)) {}
+
+tiny::Symbol::Symbol(const tiny::String &str) : Symbol(std::string_view(str.toString())) {}
+
+const tiny::String &tiny::Symbol::str() const {
+    return tiny::Interner::get().str(id);
+}
+
+std::string_view tiny::Symbol::view() const {
+    return tiny::Interner::get().view(id);
+}
@@ -0,0 +1,239 @@
+#ifndef TINY_INTERNER_H
+#define TINY_INTERNER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "unicode.h"
+
+namespace tiny {
+    /*!
+     * \brief A Symbol is a handle to a string held by the Interner
+     *
+     * A Symbol is a 32-bit handle to a string held by the Interner. Every distinct string is interned once, so two
+     * Symbols are equal if and only if their strings are equal, and comparing or hashing them is an integer operation.
+     * The default Symbol is the empty string.
+     */
+    class Symbol {
+    public:
+        /*!
+         * \brief Creates the empty symbol
+         */
+        Symbol() = default;
+
+        /*!
+         * \brief Interns a C-string
+         * \param str A UTF-8 encoded C-string
+         */
+        Symbol(const char str[]) : Symbol(std::string_view(str)) {};
+
+        /*!
+         * \brief Interns a unicode string
+         * \param str The string to intern
+         */
+        Symbol(const tiny::String &str);
+
+        /*!
+         * \brief Interns a sequence of UTF-8 bytes
+         * \param str UTF-8 encoded bytes
+         */
+        explicit Symbol(std::string_view str);
+
+        /*!
+         * \brief Builds a Symbol from an id previously returned by getId()
+         * \param id The id of the symbol
+         * \return The symbol with the given id
+         */
+        [[nodiscard]] static tiny::Symbol fromId(std::uint32_t id) {
+            tiny::Symbol sym;
+            sym.id = id;
+
+            return sym;
+        }
+
+        /*!
+         * \brief Gets the id of the symbol
+         * \return The 32-bit id of the symbol. The empty string is always 0
+         */
+        [[nodiscard]] std::uint32_t getId() const {
+            return id;
+        }
+
+        /*!
+         * \brief Gets the interned string
+         * \return A reference to the interned tiny::String. Valid for the lifetime of the program
+         */
+        [[nodiscard]] const tiny::String &str() const;
+
+        /*!
+         * \brief Gets the interned UTF-8 bytes
+         * \return A view over the UTF-8 encoding of the string. Valid for the lifetime of the program
+         */
+        [[nodiscard]] std::string_view view() const;
+
+        /*!
+         * \brief Gets the interned string as a std::string
+         * \return A UTF-8 encoded std::string
+         */
+        [[nodiscard]] std::string toString() const {
+            return std::string(view());
+        }
+
+        /*!
+         * \brief Checks whether the symbol is the empty string
+         * \return True if the symbol is the empty string
+         */
+        [[nodiscard]] bool empty() const {
+            return id == 0;
+        }
+
+        [[nodiscard]] bool operator==(const tiny::Symbol &rhs) const {
+            return id == rhs.id;
+        }
+
+        [[nodiscard]] bool operator!=(const tiny::Symbol &rhs) const {
+            return id != rhs.id;
+        }
+
+        /*!
+         * \brief Orders symbols by id. This is the order of interning, not the order of the strings
+         */
+        [[nodiscard]] bool operator<(const tiny::Symbol &rhs) const {
+            return id < rhs.id;
+        }
+
+    private:
+        //! Id of the symbol inside the Interner
+        std::uint32_t id = 0;
+    };
+
+    /*!
+     * \brief The Interner holds one copy of every distinct string used by the compiler
+     *
+     * The Interner holds one copy of every distinct string used by the compiler and maps it to a stable 32-bit id.
+     * It's safe to use from multiple threads: the lookup table is split in shards, each behind its own reader-writer
+     * lock, and interned entries are never moved nor freed, so they can be read without locking.
+     */
+    class Interner {
+    public:
+        /*!
+         * \brief Gets the global Interner instance
+         * \return A reference to the Interner
+         */
+        static Interner &get() {
+            static Interner instance;
+            return instance;
+        }
+
+        Interner(Interner const &) = delete;
+        void operator=(Interner const &) = delete;
+
+        /*!
+         * \brief Interns a sequence of UTF-8 bytes
+         * \param str UTF-8 encoded bytes
+         * \return The id of the string. Interning the same string again yields the same id
+         *
+         * Throws DecodeError if the bytes aren't valid UTF-8.
+         */
+        std::uint32_t intern(std::string_view str);
+
+        /*!
+         * \brief Gets the UTF-8 bytes of an interned string
+         * \param id The id of the string
+         * \return A view over the bytes
+         */
+        [[nodiscard]] std::string_view view(std::uint32_t id) const {
+            return entry(id).utf8;
+        }
+
+        /*!
+         * \brief Gets an interned string
+         * \param id The id of the string
+         * \return A reference to the string
+         */
+        [[nodiscard]] const tiny::String &str(std::uint32_t id) const {
+            return entry(id).str;
+        }
+
+        /*!
+         * \brief Gets the number of interned strings
+         * \return The number of distinct strings, including the empty string
+         */
+        [[nodiscard]] std::size_t size() const {
+            return nextId.load(std::memory_order_acquire);
+        }
+
+    private:
+        Interner();
+        ~Interner();
+
+        //! An interned string, in both its encoded and decoded forms
+        struct Entry {
+            std::string utf8;
+            tiny::String str;
+        };
+
+        //! A slice of the lookup table. A string always lands in the shard given by its hash
+        struct Shard {
+            std::shared_mutex mutex;
+            std::unordered_map<std::string_view, std::uint32_t> ids;
+        };
+
+        //! Number of shards. Must be a power of two
+        static constexpr std::size_t SHARD_COUNT = 64;
+
+        //! Entries held by the first chunk. Each following chunk is twice as big as the previous
+        static constexpr std::uint64_t FIRST_CHUNK = 1024;
+
+        //! Number of chunks needed to address every 32-bit id
+        static constexpr std::size_t CHUNK_COUNT = 23;
+
+        /*!
+         * \brief Locates the chunk and the position inside of it of an id
+         * \param id The id to locate
+         * \return A pair of the chunk index and the offset inside the chunk
+         */
+        [[nodiscard]] static std::pair<std::size_t, std::size_t> locate(std::uint32_t id);
+
+        /*!
+         * \brief Gets the entry of an id
+         * \param id The id of the entry
+         * \return A reference to the entry
+         */
+        [[nodiscard]] const Entry &entry(std::uint32_t id) const {
+            auto [chunk, offset] = locate(id);
+            return chunks[chunk].load(std::memory_order_acquire)[offset];
+        }
+
+        //! The lookup table, split in shards
+        std::array<Shard, SHARD_COUNT> shards;
+
+        //! Storage for the entries. Chunks are allocated on demand and never move
+        std::array<std::atomic<Entry *>, CHUNK_COUNT> chunks{};
+
+        //! Serializes the allocation of new chunks
+        std::mutex chunkMutex;
+
+        //! Id of the next interned string
+        std::atomic<std::uint32_t> nextId = 0;
+    };
+}
+
+namespace std {
+    //! Allows tiny::Symbol to be used as the key of unordered containers
+    template<>
+    struct hash<tiny::Symbol> {
+        std::size_t operator()(const tiny::Symbol &sym) const noexcept {
+            return std::hash<std::uint32_t>()(sym.getId());
+        }
+    };
+}
+
+#endif //TINY_INTERNER_H
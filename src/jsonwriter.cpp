@@ -0,0 +1,226 @@
+#include "jsonwriter.h"
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "errors.h"
+
+tiny::JSONWriter::JSONWriter(const std::filesystem::path &path, tiny::JSONLayout l) : layout(l), filePath(path) {
+#if !defined(_WIN32)
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw tiny::FileError("Unable to open '" + path.string() + "'");
+    }
+#else
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw tiny::FileError("Unable to open '" + path.string() + "'");
+    }
+
+    stream = &file;
+#endif
+
+    buffer.reserve(BUFFER_SIZE);
+}
+
+tiny::JSONWriter::JSONWriter(std::ostream &out, tiny::JSONLayout l) : layout(l), stream(&out) {
+    buffer.reserve(BUFFER_SIZE);
+}
+
+tiny::JSONWriter::~JSONWriter() {
+    try {
+        flush();
+    } catch (const tiny::FileError &) {
+        // Destructors can't throw. Callers that care about write errors flush before the writer is destroyed
+    }
+
+#if !defined(_WIN32)
+    if (fd >= 0) {
+        ::close(fd);
+    }
+#endif
+}
+
+void tiny::JSONWriter::flush() {
+    if (buffer.empty()) {
+        return;
+    }
+
+#if !defined(_WIN32)
+    if (fd >= 0) {
+        const char *data = buffer.data();
+        std::size_t left = buffer.size();
+        while (left > 0) {
+            auto written = ::write(fd, data, left);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                buffer.clear();
+                throw tiny::FileError("Unable to write to '" + filePath.string() + "'");
+            }
+
+            data += written;
+            left -= std::size_t(written);
+        }
+
+        buffer.clear();
+        return;
+    }
+#endif
+
+    stream->write(buffer.data(), std::streamsize(buffer.size()));
+    buffer.clear();
+
+    if (!*stream) {
+        throw tiny::FileError("Unable to write the JSON output");
+    }
+}
+
+void tiny::JSONWriter::separate() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+
+    if (open.empty()) {
+        return;
+    }
+
+    if (open.back()) {
+        put(',');
+    }
+
+    open.back() = true;
+    indent();
+}
+
+void tiny::JSONWriter::indent() {
+    if (layout != tiny::JSONLayout::Pretty) {
+        return;
+    }
+
+    put('\n');
+    for (std::size_t i = 0; i < open.size(); i++) {
+        write("    ");
+    }
+}
+
+void tiny::JSONWriter::beginObject() {
+    separate();
+    put('{');
+    open.push_back(false);
+}
+
+void tiny::JSONWriter::endObject() {
+    bool hasElements = open.back();
+    open.pop_back();
+
+    // Empty objects are written as {}
+    if (hasElements) {
+        indent();
+    }
+
+    put('}');
+}
+
+void tiny::JSONWriter::beginArray() {
+    separate();
+    put('[');
+    open.push_back(false);
+}
+
+void tiny::JSONWriter::endArray() {
+    bool hasElements = open.back();
+    open.pop_back();
+
+    if (hasElements) {
+        indent();
+    }
+
+    put(']');
+}
+
+void tiny::JSONWriter::key(std::string_view k) {
+    separate();
+    string(k);
+    write(layout == tiny::JSONLayout::Pretty ? ": " : ":");
+    afterKey = true;
+}
+
+void tiny::JSONWriter::value(std::string_view str) {
+    separate();
+    string(str);
+}
+
+void tiny::JSONWriter::value(const char *str) {
+    value(std::string_view(str));
+}
+
+void tiny::JSONWriter::value(bool b) {
+    separate();
+    write(b ? "true" : "false");
+}
+
+void tiny::JSONWriter::value(std::uint64_t n) {
+    separate();
+    write(std::to_string(n));
+}
+
+void tiny::JSONWriter::endLine() {
+    put('\n');
+}
+
+void tiny::JSONWriter::string(std::string_view str) {
+    static constexpr char HEX[] = "0123456789abcdef";
+
+    put('"');
+
+    // Copy the runs of characters that need no escaping in one go
+    std::size_t run = 0;
+    for (std::size_t i = 0; i < str.size(); i++) {
+        auto c = static_cast<unsigned char>(str[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        write(str.substr(run, i - run));
+        run = i + 1;
+
+        switch (c) {
+        case '"':
+            write("\\\"");
+            break;
+        case '\\':
+            write("\\\\");
+            break;
+        case '\b':
+            write("\\b");
+            break;
+        case '\f':
+            write("\\f");
+            break;
+        case '\n':
+            write("\\n");
+            break;
+        case '\r':
+            write("\\r");
+            break;
+        case '\t':
+            write("\\t");
+            break;
+        default:
+            write("\\u00");
+            put(HEX[c >> 4]);
+            put(HEX[c & 0xF]);
+            break;
+        }
+    }
+
+    write(str.substr(run));
+    put('"');
+}
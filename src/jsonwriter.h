@@ -0,0 +1,132 @@
+#ifndef TINY_JSONWRITER_H
+#define TINY_JSONWRITER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_WIN32)
+#include <fstream>
+#endif
+
+namespace tiny {
+    //! Layout of the text produced by a JSONWriter
+    enum class JSONLayout {
+        //! Indented by four spaces, byte for byte like nlohmann::json::dump(4)
+        Pretty,
+        //! Without any whitespace, byte for byte like nlohmann::json::dump()
+        Compact,
+    };
+
+    /*!
+     * \brief Writes JSON text as it's being produced, without building a document first
+     *
+     * A JSONWriter receives a stream of events (the start and end of objects and arrays, keys and values) and writes
+     * the matching text into a buffer, which is flushed to its output every time it fills up. Memory use stays
+     * constant no matter the size of the document. Keys are written in the order they are given, so to match the
+     * output of nlohmann::json they must be given sorted.
+     */
+    class JSONWriter {
+    public:
+        /*!
+         * \brief Creates a writer that outputs to a file
+         * \param path Path of the file, which is created or truncated. Throws FileError if it can't be opened
+         * \param l Layout of the text
+         */
+        explicit JSONWriter(const std::filesystem::path &path, tiny::JSONLayout l = tiny::JSONLayout::Pretty);
+
+        /*!
+         * \brief Creates a writer that outputs to a stream
+         * \param out The stream. It must outlive the writer
+         * \param l Layout of the text
+         */
+        explicit JSONWriter(std::ostream &out, tiny::JSONLayout l = tiny::JSONLayout::Pretty);
+
+        //! Flushes the remaining text and closes the file, if any
+        ~JSONWriter();
+
+        JSONWriter(const JSONWriter &) = delete;
+        JSONWriter &operator=(const JSONWriter &) = delete;
+
+        void beginObject();
+        void endObject();
+        void beginArray();
+        void endArray();
+
+        /*!
+         * \brief Writes the key of the next value inside an object
+         * \param k The key
+         */
+        void key(std::string_view k);
+
+        void value(std::string_view str);
+        void value(const char *str);
+        void value(bool b);
+        void value(std::uint64_t n);
+
+        /*!
+         * \brief Ends the current top-level value with a new line
+         *
+         * Used to write one document per line (NDJSON). Must be called outside any object or array.
+         */
+        void endLine();
+
+        /*!
+         * \brief Writes the buffered text into the output
+         *
+         * Throws FileError if the output can't be written.
+         */
+        void flush();
+
+    private:
+        //! Size of the buffer that is flushed at once
+        static constexpr std::size_t BUFFER_SIZE = 64 * 1024;
+
+        //! Writes the separator and indentation that go before a key or a value
+        void separate();
+        //! Writes the indentation of a line at the current depth
+        void indent();
+        //! Writes a quoted and escaped string
+        void string(std::string_view str);
+
+        void write(std::string_view str) {
+            buffer.append(str);
+            if (buffer.size() >= BUFFER_SIZE) {
+                flush();
+            }
+        }
+
+        void put(char c) {
+            buffer.push_back(c);
+            if (buffer.size() >= BUFFER_SIZE) {
+                flush();
+            }
+        }
+
+        //! Layout of the text
+        tiny::JSONLayout layout;
+        //! Text waiting to be flushed
+        std::string buffer;
+
+        //! Whether each open object or array, innermost last, already has an element
+        std::vector<bool> open;
+        //! Whether a key was just written, so the next value goes right after it
+        bool afterKey = false;
+
+        //! The output file, or -1 when writing into a stream
+        int fd = -1;
+        //! The output stream, if not writing into a file
+        std::ostream *stream = nullptr;
+#if defined(_WIN32)
+        //! The output file, on platforms without POSIX file descriptors
+        std::ofstream file;
+#endif
+        //! Path of the output file, for error messages
+        std::filesystem::path filePath;
+    };
+}
+
+#endif //TINY_JSONWRITER_H
@@ -0,0 +1,119 @@
+#include "lexemestream.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+tiny::LexemeStream::LexemeStream(tiny::TokenBuffer tokens) : ring(std::move(tokens)) {
+    // Everything is buffered and nothing will be evicted, but the ring is still indexed with a mask
+    end = ring.size();
+
+    std::size_t capacity = INITIAL_CAPACITY;
+    while (capacity < end) {
+        capacity *= 2;
+    }
+
+    ring.resize(capacity);
+}
+
+tiny::TokenRef tiny::LexemeStream::get() {
+    if (!fill(index)) {
+        return terminator;
+    }
+
+    return at(index++);
+}
+
+tiny::TokenRef tiny::LexemeStream::peek(std::uint64_t offset) {
+    return at(index + offset);
+}
+
+tiny::TokenRef tiny::LexemeStream::last() {
+    if (index == 0) {
+        return terminator;
+    }
+
+    return at(index - 1);
+}
+
+void tiny::LexemeStream::backup() {
+    // Same as Stream::rewind: if the cursor is over the end it starts from the last Lexeme
+    if (index > 0 && !fill(index - 1)) {
+        index = end > 0 ? end - 1 : 0;
+    }
+
+    index = index <= 1 ? 0 : index - 1;
+}
+
+tiny::TokenRef tiny::LexemeStream::at(std::uint64_t i) {
+    if (!fill(i)) {
+        return terminator;
+    }
+
+    if (i < base) {
+        throw std::out_of_range("Lexeme at position " + std::to_string(i) + " is no longer buffered");
+    }
+
+    return ring[i & (ring.size() - 1)];
+}
+
+bool tiny::LexemeStream::fill(std::uint64_t i) {
+    while (end <= i) {
+        if (lexer == nullptr || !*lexer) {
+            return false;
+        }
+
+        auto lexeme = lexer->lex();
+        if (lexeme.isNone()) {
+            continue;
+        }
+
+        reserve();
+        ring.set(end & (ring.size() - 1), lexeme);
+        end++;
+    }
+
+    return true;
+}
+
+void tiny::LexemeStream::reserve() {
+    if (end - base < ring.size()) {
+        return;
+    }
+
+    // Drop everything before the oldest position that can still be reached: the one before the cursor or before any
+    // of the checkpoints
+    auto oldest = index;
+    for (auto p: pins) {
+        oldest = std::min(oldest, p);
+    }
+
+    if (oldest > 0) {
+        base = std::max(base, std::min(oldest - 1, end));
+    }
+
+    if (end - base < ring.size()) {
+        return;
+    }
+
+    // The whole window is still needed, so grow the ring. Sizes are kept as powers of two to index with a mask.
+    tiny::TokenBuffer grown(lexer->getMetadataFile(), lexer->getSource().view());
+    grown.resize(ring.empty() ? INITIAL_CAPACITY : ring.size() * 2);
+    for (auto p = base; p < end; p++) {
+        grown.set(p & (grown.size() - 1), ring[p & (ring.size() - 1)]);
+    }
+
+    ring = std::move(grown);
+}
+
+void tiny::LexemeStream::pin(std::uint64_t i) {
+    pins.push_back(i);
+}
+
+void tiny::LexemeStream::unpin(std::uint64_t i) {
+    auto it = std::find(pins.rbegin(), pins.rend(), i);
+    if (it != pins.rend()) {
+        pins.erase(std::next(it).base());
+    }
+}
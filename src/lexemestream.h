@@ -0,0 +1,227 @@
+#ifndef TINY_LEXEMESTREAM_H
+#define TINY_LEXEMESTREAM_H
+
+#include <cstdint>
+#include <vector>
+
+#include "lexer.h"
+#include "tokenbuffer.h"
+
+namespace tiny {
+    /*!
+     * \brief A LexemeStream pulls Lexemes from a Lexer as they're requested
+     *
+     * A LexemeStream exposes the Lexemes of a Lexer through the same cursor interface as a Stream, but only lexes up to
+     * the furthest position that has been looked at. Lexemes are kept in a TokenBuffer used as a ring, that only holds
+     * the window between the oldest position that can still be returned to and the furthest lookahead, so the memory
+     * needed is bounded by the lookahead instead of by the length of the file. They're returned as TokenRef handles,
+     * which stay usable after they leave the window.
+     *
+     * Positions that must stay reachable are pinned by taking a Checkpoint, and are released once the Checkpoint is
+     * destroyed. Besides those, only the Lexeme right before the cursor is kept. Lexing errors are thrown as LexError
+     * from the call that required the Lexeme.
+     */
+    class LexemeStream {
+    public:
+        /*!
+         * \brief A Checkpoint keeps a position of a LexemeStream reachable while it lives
+         *
+         * A Checkpoint is taken with LexemeStream::checkpoint and is used to go back to that position with
+         * LexemeStream::seek. The Lexemes from the position onward (and the one before it) aren't dropped from the
+         * buffer until the Checkpoint is destroyed.
+         */
+        class Checkpoint {
+        public:
+            Checkpoint(const Checkpoint &) = delete;
+            Checkpoint &operator=(const Checkpoint &) = delete;
+
+            ~Checkpoint() {
+                stream.unpin(index);
+            }
+
+            /*!
+             * \brief Gets the pinned position
+             * \return The index of the stream when the Checkpoint was taken
+             */
+            [[nodiscard]] std::uint64_t getIndex() const {
+                return index;
+            }
+
+        private:
+            friend class LexemeStream;
+
+            /*!
+             * \brief Pins a position of a stream
+             * \param stream The stream to pin
+             * \param index The position to pin
+             */
+            Checkpoint(LexemeStream &stream, std::uint64_t index) : stream(stream), index(index) {
+                stream.pin(index);
+            }
+
+            //! The pinned stream
+            LexemeStream &stream;
+
+            //! The pinned position
+            std::uint64_t index;
+        };
+
+        /*!
+         * \brief Builds an empty stream that only yields the terminator
+         */
+        explicit LexemeStream() = default;
+
+        /*!
+         * \brief Builds a stream over a Lexer
+         * \param lexer The Lexer to pull Lexemes from. It must outlive the stream
+         */
+        explicit LexemeStream(tiny::Lexer &lexer) : lexer(&lexer) {};
+
+        /*!
+         * \brief Builds a stream over Lexemes that were already lexed
+         * \param tokens The Lexemes. Their source must outlive the stream
+         */
+        explicit LexemeStream(tiny::TokenBuffer tokens);
+
+        LexemeStream(const LexemeStream &) = delete;
+        LexemeStream &operator=(const LexemeStream &) = delete;
+
+        /*!
+         * \brief Check whether the end of the stream has been reached
+         * \return True if there's still Lexemes in the stream, false otherwise
+         *
+         * Checking for the end might require lexing the next Lexeme, thus it might throw LexError.
+         */
+        explicit operator bool() {
+            return fill(index);
+        }
+
+        /*!
+         * \brief Fetches the next Lexeme and advances the stream
+         * \return The next Lexeme, or the terminator if the Lexer has been exhausted
+         */
+        [[nodiscard]] tiny::TokenRef get();
+
+        /*!
+         * \brief Fetches a Lexeme ahead of the cursor without advancing the stream
+         * \param offset How far from the cursor to look. By default the next Lexeme
+         * \return The Lexeme, or the terminator if the Lexer is exhausted before reaching it
+         */
+        [[nodiscard]] tiny::TokenRef peek(std::uint64_t offset = 0);
+
+        /*!
+         * \brief Fetches the Lexeme right before the cursor
+         * \return The last Lexeme returned by get, or the terminator if the cursor is at the start
+         */
+        [[nodiscard]] tiny::TokenRef last();
+
+        //! Goes back one position
+        void backup();
+
+        //! Goes forwards one position
+        void skip() {
+            index++;
+        }
+
+        /*!
+         * \brief Pins the current position
+         * \return A Checkpoint that can be passed to seek while it lives
+         */
+        [[nodiscard]] Checkpoint checkpoint() {
+            return Checkpoint(*this, index);
+        }
+
+        /*!
+         * \brief Goes back (or forward) to a pinned position
+         * \param checkpoint The position to go to
+         */
+        void seek(const Checkpoint &checkpoint) {
+            index = checkpoint.getIndex();
+        }
+
+        /*!
+         * \brief Gets the current position of the stream
+         * \return The stream's index
+         */
+        [[nodiscard]] std::uint64_t getIndex() const {
+            return index;
+        }
+
+        /*!
+         * \brief Gets the terminator value
+         * \return The stream's terminator value
+         */
+        [[nodiscard]] tiny::TokenRef getTerminator() const {
+            return terminator;
+        }
+
+        /*!
+         * \brief Returns whether the provided value is the terminator
+         * \param t A value to compare
+         * \return True if it's the terminator, false otherwise
+         */
+        [[nodiscard]] bool isTerminator(const tiny::TokenRef &t) const {
+            return terminator == t;
+        }
+
+        /*!
+         * \brief Gets the number of Lexemes currently held in the buffer
+         * \return The size of the window between the oldest reachable position and the furthest lookahead
+         */
+        [[nodiscard]] std::size_t buffered() const {
+            return end - base;
+        }
+
+    private:
+        /*!
+         * \brief Gets the Lexeme at a position, lexing up to it if needed
+         * \param i The position of the Lexeme
+         * \return The Lexeme, or the terminator if the Lexer is exhausted before reaching it
+         */
+        [[nodiscard]] tiny::TokenRef at(std::uint64_t i);
+
+        /*!
+         * \brief Lexes until the position is buffered or the Lexer is exhausted
+         * \param i The position to reach
+         * \return True if the position is buffered
+         */
+        bool fill(std::uint64_t i);
+
+        /*!
+         * \brief Makes room for one more Lexeme in the ring, dropping the unreachable ones or growing it
+         */
+        void reserve();
+
+        //! Marks a position as reachable
+        void pin(std::uint64_t i);
+
+        //! Releases a position marked by pin
+        void unpin(std::uint64_t i);
+
+        //! The first Lexemes the buffer starts with
+        static constexpr std::size_t INITIAL_CAPACITY = 16;
+
+        //! Source of the Lexemes. With a null Lexer only the Lexemes already in the ring are streamed
+        tiny::Lexer *lexer = nullptr;
+
+        //! Ring of buffered Lexemes. The Lexeme at position i lives in ring[i % ring.size()]
+        tiny::TokenBuffer ring;
+
+        //! Position of the oldest buffered Lexeme
+        std::uint64_t base = 0;
+
+        //! Position after the newest buffered Lexeme
+        std::uint64_t end = 0;
+
+        //! Current position of the cursor
+        std::uint64_t index = 0;
+
+        //! Pinned positions. Checkpoints are usually nested, so there's only a handful at a time
+        std::vector<std::uint64_t> pins;
+
+        //! Terminator value
+        tiny::TokenRef terminator{};
+    };
+}
+
+#endif //TINY_LEXEMESTREAM_H
@@ -1,7 +1,26 @@
 #include "lexer.h"
 
+#include <algorithm>
+#include <charconv>
+#include <exception>
+#include <limits>
+#include <thread>
 #include <utility>
 #include "errors.h"
+#include "tokenbuffer.h"
+#include "charclass.h"
+#include "scan.h"
+
+// The operator automaton is built by the compiler. Check a few of the longest-match rules while at it.
+static_assert(tiny::Lexer::OPERATOR_MATCHER.match("**=").first == tiny::Token::Exp);
+static_assert(tiny::Lexer::OPERATOR_MATCHER.match("..5").second == 2);
+static_assert(tiny::Lexer::OPERATOR_MATCHER.match("/*").first == tiny::Token::MultilineComment);
+static_assert(tiny::Lexer::OPERATOR_MATCHER.match("a").second == 0);
+
+// Same for the keyword hash
+static_assert(tiny::Lexer::KEYWORD_HASH.find("uint16") == tiny::Token::TypeUInt16);
+static_assert(tiny::Lexer::KEYWORD_HASH.find("uint128") == tiny::Token::None);
+static_assert(tiny::Lexer::KEYWORD_HASH.find("i") == tiny::Token::None);
 
 std::vector<tiny::Lexeme> tiny::Lexer::lexAll()
 {
@@ -18,14 +37,308 @@ std::vector<tiny::Lexeme> tiny::Lexer::lexAll()
     return lexemes;
 }
 
+tiny::TokenBuffer tiny::Lexer::tokenize()
+{
+    tiny::TokenBuffer buffer(file, s.getSource().view());
+    while (operator bool()) {
+        tiny::Lexeme lexeme = lex();
+        if (lexeme.isNone()) {
+            continue;
+        }
+
+        buffer.push(lexeme);
+    }
+
+    return buffer;
+}
+
+namespace {
+    //! A point where a chunk's Lexer was about to lex a token, and how much it had produced by then
+    struct Resume {
+        //! Byte offset of the stream
+        std::uint64_t offset;
+
+        //! Number of tokens lexed before it
+        std::size_t tokens;
+
+        //! Number of comments collected before it
+        std::size_t trivia;
+
+        //! Number of errors stored before it
+        std::size_t diagnostics;
+    };
+
+    //! The result of lexing a chunk of the source on its own
+    struct Chunk {
+        //! Tokens of the chunk
+        tiny::TokenBuffer tokens;
+
+        //! Comments of the chunk, in TriviaMode::Collect
+        std::vector<tiny::Lexeme> trivia;
+
+        //! Errors of the chunk, in ErrorMode::Recover
+        std::vector<tiny::LexError> diagnostics;
+
+        //! Every point where a token was lexed from, in order
+        std::vector<Resume> resumes;
+
+        //! Byte offset where the lexing stopped. Can be past the end of the chunk if its last token crosses the end
+        std::uint64_t end = 0;
+
+        //! Errors thrown, with the index of the resume point they were lexed from
+        std::vector<std::pair<std::size_t, std::exception_ptr>> errors;
+    };
+}
+
+tiny::TokenBuffer tiny::Lexer::tokenizeParallel(unsigned threads, std::size_t minChunk)
+{
+    if (threads == 0) {
+        threads = (std::max)(1u, std::thread::hardware_concurrency());
+    }
+
+    auto source = s.getSource().view();
+    auto from = s.getIndex();
+    auto size = std::uint64_t(source.size());
+
+    auto count = from < size ? (std::min)(std::uint64_t(threads), (size - from) / (std::max)(minChunk, std::size_t(1)))
+                             : 0;
+    if (count < 2) {
+        return tokenize();
+    }
+
+    // Split at the newline closest after each equally-sized part. Chunks might end up empty, which is harmless.
+    std::vector<std::uint64_t> bounds{from};
+    for (std::uint64_t i = 1; i < count; i++) {
+        auto newline = source.find('\n', from + (size - from) * i / count);
+        bounds.push_back(newline == std::string_view::npos ? size : (std::max)(bounds.back(), newline + 1));
+    }
+    bounds.push_back(size);
+
+    // Lexes chunk i as if it started at a token boundary
+    std::vector<Chunk> chunks(count);
+    auto lexChunk = [&](std::size_t i) {
+        auto &chunk = chunks[i];
+        chunk.tokens = tiny::TokenBuffer(file, source);
+
+        tiny::Lexer lexer(*this);
+        lexer.trivia.clear();
+        lexer.diagnostics.clear();
+        lexer.s.seek(bounds[i]);
+
+        while (lexer && lexer.s.getIndex() < bounds[i + 1]) {
+            chunk.resumes.push_back({lexer.s.getIndex(), chunk.tokens.size(), lexer.trivia.size(),
+                                     lexer.diagnostics.size()});
+
+            try {
+                auto lexeme = lexer.lex();
+                if (!lexeme.isNone()) {
+                    chunk.tokens.push(lexeme);
+                }
+            } catch (...) {
+                chunk.errors.emplace_back(chunk.resumes.size() - 1, std::current_exception());
+
+                // The error might come from starting in the middle of a token, so try to sync up on the next line.
+                // The first chunk can't be out of sync.
+                auto newline = source.find('\n', chunk.resumes.back().offset);
+                if (i == 0 || newline == std::string_view::npos) {
+                    break;
+                }
+
+                lexer.s.seek(newline + 1);
+            }
+        }
+
+        chunk.end = lexer.s.getIndex();
+        chunk.trivia = std::move(lexer.trivia);
+        chunk.diagnostics = std::move(lexer.diagnostics);
+    };
+
+    // The first chunk starts where this Lexer is, so it's always right. It's lexed on this thread.
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < count; i++) {
+        workers.emplace_back(lexChunk, i);
+    }
+
+    lexChunk(0);
+    for (auto &w: workers) {
+        w.join();
+    }
+
+    // Stitch the chunks in order. pos is where sequential lexing would be at each moment.
+    tiny::TokenBuffer buffer(file, source);
+    auto pos = from;
+
+    tiny::Lexer sequential(*this);
+    sequential.trivia.clear();
+    sequential.diagnostics.clear();
+
+    for (std::size_t i = 0; i < count; i++) {
+        auto &chunk = chunks[i];
+
+        while (pos < bounds[i + 1] && pos < size) {
+            auto resume = std::lower_bound(chunk.resumes.begin(), chunk.resumes.end(), pos,
+                                           [](const Resume &r, std::uint64_t offset) { return r.offset < offset; });
+
+            if (resume != chunk.resumes.end() && resume->offset == pos) {
+                // In sync: from here on the chunk was lexed exactly as it would have been sequentially
+                for (auto t = resume->tokens; t < chunk.tokens.size(); t++) {
+                    buffer.push(chunk.tokens[t]);
+                }
+
+                sequential.trivia.insert(sequential.trivia.end(), chunk.trivia.begin() + resume->trivia,
+                                         chunk.trivia.end());
+                sequential.diagnostics.insert(sequential.diagnostics.end(),
+                                              chunk.diagnostics.begin() + resume->diagnostics, chunk.diagnostics.end());
+
+                // Errors lexed from before the sync point don't happen sequentially, but the rest do
+                auto r = std::size_t(resume - chunk.resumes.begin());
+                for (auto const &[at, error]: chunk.errors) {
+                    if (at >= r) {
+                        std::rethrow_exception(error);
+                    }
+                }
+
+                pos = chunk.end;
+                break;
+            }
+
+            // Out of sync, since the chunk started in the middle of a token. Lex one token and try again.
+            sequential.s.seek(pos);
+
+            auto lexeme = sequential.lex();
+            if (!lexeme.isNone()) {
+                buffer.push(lexeme);
+            }
+
+            pos = sequential.s.getIndex();
+        }
+    }
+
+    s.seek(pos);
+    trivia.insert(trivia.end(), sequential.trivia.begin(), sequential.trivia.end());
+    diagnostics.insert(diagnostics.end(), sequential.diagnostics.begin(), sequential.diagnostics.end());
+
+    return buffer;
+}
+
+namespace {
+    /*!
+     * \brief Gets the byte offset a token was lexed from
+     * \param token The Token
+     * \param start Byte offset of the token start
+     * \return The offset of the first byte of the token
+     *
+     * NewLine tokens start right after the newline they stand for, so their first byte is the one before their start.
+     */
+    std::uint64_t origin(tiny::Token token, std::uint64_t start) {
+        return token == tiny::Token::NewLine ? start - 1 : start;
+    }
+}
+
+tiny::TokenBuffer tiny::Lexer::relex(const tiny::TokenBuffer &tokens, const tiny::TextEdit &edit)
+{
+    auto source = s.getSource().view();
+    auto shift = edit.getShift();
+
+    // Tokens that start before the edit stay the same, except for the last one, which might run into it. Without
+    // such a token everything is lexed again, since skipped comments before the first token aren't in the buffer.
+    std::size_t first = 0;
+    while (first < tokens.size() && origin(tokens[first].token, tokens[first].start) < edit.offset) {
+        first++;
+    }
+
+    tiny::TokenBuffer buffer(file, source);
+    if (first > 0) {
+        first--;
+        buffer.append(tokens, 0, first, 0);
+        s.seek(origin(tokens[first].token, tokens[first].start));
+    } else {
+        s.seek(0);
+    }
+
+    // Old tokens are in order, so the search for one to sync up with never goes back
+    auto old = first;
+    while (operator bool()) {
+        auto lexeme = lex();
+        if (lexeme.isNone()) {
+            continue;
+        }
+
+        auto at = std::int64_t(origin(lexeme.token, lexeme.metadata.start));
+        if (at >= std::int64_t(edit.getEnd())) {
+            while (old < tokens.size() && std::int64_t(origin(tokens[old].token, tokens[old].start)) + shift < at) {
+                old++;
+            }
+
+            if (old < tokens.size() && std::int64_t(origin(tokens[old].token, tokens[old].start)) + shift == at &&
+                tokens[old].token == lexeme.token) {
+                // Both lexings go over the same bytes from the same point, so every token from here on is the same
+                buffer.append(tokens, old, tokens.size(), shift);
+                s.seek(source.size());
+
+                return buffer;
+            }
+        }
+
+        buffer.push(lexeme);
+    }
+
+    return buffer;
+}
+
 tiny::Lexeme tiny::Lexer::lex()
 {
-    // Skip over blank chars
+    try {
+        return next();
+    } catch (const tiny::LexError &e) {
+        if (errorMode == ErrorMode::Throw) {
+            throw;
+        }
+
+        diagnostics.push_back(e);
+        recover(e.meta);
+
+        return tiny::Lexeme(tiny::Token::None, e.meta);
+    }
+}
+
+void tiny::Lexer::recover(const tiny::Metadata &error)
+{
+    auto first = s.get(error.start);
+
+    if (first == '"' || first == '\'') {
+        // The newline itself is kept, since it's a token
+        auto newline = s.getSource().view().find('\n', error.start);
+        s.seek(newline == std::string_view::npos ? s.length() : newline);
+        return;
+    }
+
+    // Never resume at the error, or it would be found again
+    if (s.getIndex() <= error.start) {
+        s.seek(error.start);
+        s.skip();
+    }
+
+    if (tiny::isDigit(first)) {
+        for (auto peek = s.peek(); tiny::isIdContinue(peek) || peek == '.'; peek = s.peek()) {
+            s.skip();
+        }
+    }
+}
+
+tiny::Lexeme tiny::Lexer::next()
+{
+    // Skip over blank chars. Runs of blanks are skipped in bulk, but the last blank before the end of the source is
+    // left for the loop below
+    if (auto remaining = s.remaining(); !remaining.empty()) {
+        s.seek(s.getIndex() + (std::min)(tiny::countBlanks(remaining), remaining.size() - 1));
+    }
+
     std::uint32_t input;
     do {
         input = s.get();
     }
-    while ((isblank(char(input)) || input=='\r') && s);
+    while ((tiny::isBlank(input) || input=='\r') && s);
     // Blanks and carriage returns get discarded
 
     if (input=='\xff') {
@@ -45,40 +358,35 @@ tiny::Lexeme tiny::Lexer::lex()
     auto meta = getMetadata();
 
     // We have non-empty char. Try to match it.
-    tiny::StreamComparator comparator(s);
-    switch (auto match = comparator.match(TOKEN_TABLE, Token::None); match) {
+    auto [match, length] = OPERATOR_MATCHER.match(s.remaining());
+    s.seek(s.getIndex() + length);
+
+    switch (match) {
     case Token::SinglelineComment: {
         meta.end += 2; // Account for the double-slash
 
-        tiny::String comment;
-        for (std::uint32_t peek = s.peek(); peek!='\n' && s; peek = s.peek()) {
-            comment += s.get();
-
-        }
+        auto from = s.getIndex();
+        s.seek(from + tiny::findNewline(s.remaining()));
 
         meta.end = s.getIndex();
-        return Lexeme(tiny::Token::SinglelineComment, comment, meta);
+        return trivium(Lexeme(tiny::Token::SinglelineComment, slice(from, s.getIndex()), meta));
     }
     case Token::MultilineComment: {
         meta.end += 2; // Account for the comment start
 
-        tiny::String comment;
-        while (true) {
-            if (!s) {
-                meta.end = s.getIndex();
-                throw tiny::LexError("Unclosed multiline comment", getMetadata());
-            }
+        auto from = s.getIndex();
+        auto to = from + tiny::findCommentEnd(s.remaining());
 
-            std::uint32_t got = s.get();
-            if (got=='*' && s.peek()=='/') {
-                s.skip();
+        s.seek(to);
+        if (!s) {
+            meta.end = s.getIndex();
+            throw tiny::LexError("Unclosed multiline comment", getMetadata());
+        }
 
-                meta.end = s.getIndex();
-                return Lexeme{tiny::Token::MultilineComment, comment, meta};
-            }
+        s.seek(to + 2); // Step over the comment end
 
-            comment += got;
-        }
+        meta.end = s.getIndex();
+        return trivium(Lexeme{tiny::Token::MultilineComment, slice(from, to), meta});
     }
     case Token::None:
         break; // Nothing matched should try the strategies below
@@ -88,12 +396,12 @@ tiny::Lexeme tiny::Lexer::lex()
     }
 
     // Identifier or keyword
-    if (iswalpha(std::int32_t(input)) || input=='_') {
+    if (tiny::isIdStart(input)) {
         return lexId();
     }
 
     // Numeric literal
-    if (isdigit(char(input)) || (input=='0' && s.peek()=='x')) {
+    if (tiny::isDigit(input)) {
         return lexNumericLiteral();
     }
 
@@ -111,6 +419,22 @@ tiny::Lexeme tiny::Lexer::lex()
     throw tiny::LexError("Unknown symbol '"+tiny::String(input).toString()+"'", meta);
 }
 
+tiny::Lexeme tiny::Lexer::trivium(tiny::Lexeme comment)
+{
+    switch (triviaMode) {
+    case TriviaMode::Emit:
+        return comment;
+    case TriviaMode::Collect:
+        trivia.push_back(comment);
+        break;
+    case TriviaMode::Skip:
+        break;
+    }
+
+    // Callers already discard None lexemes, so the comment leaves no trace in the token stream
+    return tiny::Lexeme(tiny::Token::None, comment.metadata);
+}
+
 tiny::Lexeme tiny::Lexer::lexId()
 {
     auto meta = getMetadata();
@@ -121,15 +445,13 @@ tiny::Lexeme tiny::Lexer::lexId()
         throw tiny::LexError("End-of-file while parsing ID", meta);
     }
 
-    tiny::String id(input);
-
-    for (auto peek = s.peek();
-         iswalpha(std::int32_t(peek)) || isdigit(char(peek)) || peek=='_'; peek = s.peek()) {
-        id += s.get();
+    for (auto peek = s.peek(); tiny::isIdContinue(peek); peek = s.peek()) {
+        s.skip();
     }
 
-    if (auto match = KEYWORD_TABLE.find(id); match!=KEYWORD_TABLE.end()) {
-        return Lexeme(match->second, meta);
+    auto id = slice(meta.start, s.getIndex());
+    if (auto keyword = KEYWORD_HASH.find(id); keyword!=tiny::Token::None) {
+        return Lexeme(keyword, meta);
     }
 
     return Lexeme(tiny::Token::Id, id, meta);
@@ -147,11 +469,11 @@ tiny::Lexeme tiny::Lexer::lexNumericLiteral()
         throw tiny::LexError("End-of-file while parsing numeric literal", meta);
     }
 
-    tiny::String number(input);
     bool isHex = false;
+    bool isDecimal = false;
 
     if (input=='0') {
-        if (isdigit(char(s.peek()))) {
+        if (tiny::isDigit(s.peek())) {
             // Disallow literals like 00.1 or 001 but allow 0.1 or 0
             meta.end = s.getIndex();
             throw tiny::LexError("Numeric literals can't have a leading zero", meta);
@@ -159,21 +481,21 @@ tiny::Lexeme tiny::Lexer::lexNumericLiteral()
 
         if (s.peek()=='x') {
             // Prefixed hexadecimal literal (0xFFFF)
-            number += s.get();
+            s.skip();
             isHex = true;
         }
     }
 
     // This function checks if a character is a posible continuation of a numeric value
-    auto isContinuation = [](char c, bool hex) {
+    auto isContinuation = [](std::uint32_t c, bool hex) {
         // If we are looking for base 10 numerics, any digit and a dot are valid characters.
         // If we need to filter hex values, numbers and characters between A-F (upper- and lowercase)
         // but no decimal dots are valid characters.
 
-        return (isdigit(c) || (!hex && c=='.')) || (hex && ((c>='A' && c<='F') || (c>='a' && c<='f')));
+        return hex ? tiny::isHexDigit(c) : (tiny::isDigit(c) || c=='.');
     };
 
-    for (auto peek = char(s.peek()); isContinuation(peek, isHex); peek = char(s.peek())) {
+    for (auto peek = s.peek(); isContinuation(peek, isHex); peek = s.peek()) {
         auto got = s.get();
         if (got=='.' && s.peek()=='.') {
             // We encountered a range (..) operator. Revert and stop parsing.
@@ -181,16 +503,48 @@ tiny::Lexeme tiny::Lexer::lexNumericLiteral()
             break;
         }
 
-        number += got;
+        if (got=='.') {
+            // Make sure we reject malformed decimal numbers like 3.12.14
+            if (isDecimal) {
+                meta.end = s.getIndex();
+                throw tiny::LexError("Numeric literal has two decimal points", meta);
+            }
+
+            isDecimal = true;
+        }
     }
 
-    // Make sure we reject malformed decimal numbers like 3.12.14
-    if (std::count(number.codepoints.begin(), number.codepoints.end(), '.')>1) {
-        meta.end = s.getIndex();
-        throw tiny::LexError("Numeric literal has two decimal points", meta);
+    auto literal = slice(meta.start, s.getIndex());
+
+    if (isDecimal) {
+        long double decimal = 0;
+        auto [end, ec] = std::from_chars(literal.data(), literal.data() + literal.size(), decimal,
+                                         std::chars_format::fixed);
+        if (ec != std::errc()) {
+            meta.end = s.getIndex();
+            throw tiny::LexError("Numeric literal out of range", meta);
+        }
+
+        return Lexeme(tiny::Token::LiteralNum, literal, decimal, meta);
+    }
+
+    // Skip the 0x prefix. A bare 0x has no digits and stands for a zero
+    auto digits = isHex ? literal.substr(2) : literal;
+
+    std::uint64_t integer = 0;
+    if (!digits.empty()) {
+        auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), integer, isHex ? 16 : 10);
+        if (ec != std::errc()) {
+            meta.end = s.getIndex();
+            throw tiny::LexError("Numeric literal out of range", meta);
+        }
+    }
+
+    if (integer > std::uint64_t(std::numeric_limits<std::int64_t>::max())) {
+        return Lexeme(tiny::Token::LiteralNum, literal, integer, meta);
     }
 
-    return Lexeme(tiny::Token::LiteralNum, number, meta);
+    return Lexeme(tiny::Token::LiteralNum, literal, std::int64_t(integer), meta);
 }
 
 tiny::Lexeme tiny::Lexer::lexStrLiteral()
@@ -204,16 +558,16 @@ tiny::Lexeme tiny::Lexer::lexStrLiteral()
 
     s.skip(); // step-over the first "
 
-    tiny::String str;
-    for (std::uint32_t peek = s.peek(); peek!='"'; peek = s.peek()) {
-        if (peek==StreamTerminator) {
-            meta.end = s.getIndex();
-            throw tiny::LexError("End-of-file while parsing string literal", meta);
-        }
+    auto from = s.getIndex();
+    s.seek(from + tiny::findStringEnd(s.remaining()));
 
-        str += s.get();
+    if (s.peek()!='"') {
+        // Stopped at the end of the source or at a NUL
+        meta.end = s.getIndex();
+        throw tiny::LexError("End-of-file while parsing string literal", meta);
     }
 
+    auto str = slice(from, s.getIndex());
     s.skip(); // step-over the second "
 
     return Lexeme(tiny::Token::LiteralStr, str, meta);
@@ -230,18 +584,26 @@ tiny::Lexeme tiny::Lexer::lexCharLiteral()
 
     s.skip(); // step-over the first '
 
-    std::uint32_t next = s.get();
+    auto from = s.getIndex();
+    s.skip();
+
+    auto to = s.getIndex();
     if (s.get()!='\'') {
         meta.end = s.getIndex();
         throw tiny::LexError("Invalid char definition", meta);
     }
 
-    return Lexeme(tiny::Token::LiteralChar, tiny::String(next), meta);
+    return Lexeme(tiny::Token::LiteralChar, slice(from, to), meta);
+}
+
+void tiny::Lexer::setMetadataFile(tiny::FileId f)
+{
+    file = f;
 }
 
-void tiny::Lexer::setMetadataFile(tiny::File f)
+std::string_view tiny::Lexer::slice(std::uint64_t from, std::uint64_t to) const
 {
-    file = std::move(f);
+    return s.getSource().view().substr(from, to-from);
 }
 
 tiny::Metadata tiny::Lexer::getMetadata() const
@@ -254,11 +616,11 @@ std::string tiny::Lexeme::string() const
     switch (token) {
         // Zero-value
     case Token::None:
-        return "<None, "+value.toString()+">";
+        return "<None, "+std::string(value)+">";
 
         // Identifier
     case Token::Id:
-        return "<Identifier, "+value.toString()+">";
+        return "<Identifier, "+std::string(value)+">";
 
         // Keywords
     case Token::KwModule:
@@ -405,9 +767,9 @@ std::string tiny::Lexeme::string() const
 
         // Literals
     case Token::LiteralNum:
-        return "<Numeric Literal, "+value.toString()+">";
+        return "<Numeric Literal, "+std::string(value)+">";
     case Token::LiteralStr:
-        return "<String Literal, "+value.toString()+">";
+        return "<String Literal, "+std::string(value)+">";
     case Token::Negation:
         return "<Negation>";
 
@@ -419,9 +781,9 @@ std::string tiny::Lexeme::string() const
 
         // Comments
     case Token::SinglelineComment:
-        return "<Singleline Comment, \""+value.toString()+"\">";
+        return "<Singleline Comment, \""+std::string(value)+"\">";
     case Token::MultilineComment:
-        return "<Multiline Comment, \""+value.toString()+"\">";
+        return "<Multiline Comment, \""+std::string(value)+"\">";
 
     default:
         return "<Unknown>";
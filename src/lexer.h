@@ -1,19 +1,29 @@
 #ifndef TINY_LEXER_H
 #define TINY_LEXER_H
 
+#include <array>
+#include <initializer_list>
 #include <iostream>
 #include <ios>
 #include <unordered_map>
 #include <utility>
 #include <map>
-#include <locale>
+#include <cstdint>
+#include <variant>
+#include <vector>
 
 #include "stream.h"
+#include "source.h"
 #include "comparator.h"
 #include "metadata.h"
 #include "file.h"
+#include "interner.h"
+#include "matcher.h"
+#include "errors.h"
 
 namespace tiny {
+    class TokenBuffer;
+
     //! A Token is an identifier of the semantic context-less meaning of the code fragment.
     enum class Token {
         // Zero-value
@@ -131,6 +141,50 @@ namespace tiny {
         MultilineComment,
     };
 
+    /*!
+     * \brief A set of Tokens stored as a bitmask
+     *
+     * Membership is a single bit test, and the set can be built at compile time, so it doesn't allocate.
+     */
+    class TokenSet {
+    public:
+        //! Builds an empty set
+        constexpr TokenSet() = default;
+
+        /*!
+         * \brief Builds a set from a list of Tokens
+         * \param tokens The Tokens in the set
+         */
+        constexpr TokenSet(std::initializer_list<tiny::Token> tokens) {
+            for (auto token: tokens) {
+                add(token);
+            }
+        }
+
+        /*!
+         * \brief Adds a Token to the set
+         * \param token The Token to add
+         * \return The set itself
+         */
+        constexpr TokenSet &add(tiny::Token token) {
+            words[std::size_t(token) / 64] |= std::uint64_t(1) << (std::size_t(token) % 64);
+            return *this;
+        }
+
+        /*!
+         * \brief Checks whether a Token is in the set
+         * \param token The Token to check
+         * \return True if the Token is in the set, false otherwise
+         */
+        [[nodiscard]] constexpr bool contains(tiny::Token token) const {
+            return (words[std::size_t(token) / 64] >> (std::size_t(token) % 64)) & 1;
+        }
+
+    private:
+        //! One bit per Token
+        std::array<std::uint64_t, std::size_t(tiny::Token::MultilineComment) / 64 + 1> words{};
+    };
+
     /*!
      * \brief Returns an UnicodeCodepoints representation of the name of the token type
      * \param t Token to stringify
@@ -141,6 +195,9 @@ namespace tiny {
      */
     [[nodiscard]] tiny::String getTypeName(tiny::Token t);
 
+    //! The decoded value of a numeric literal: an int64, an uint64 for integers that don't fit in it, or a decimal
+    using Number = std::variant<std::int64_t, std::uint64_t, long double>;
+
     //! A Lexeme is the product of the Lexer. It defines a token and optionally it's associated data.
     struct Lexeme {
         explicit Lexeme() = default;
@@ -164,24 +221,37 @@ namespace tiny {
         /*!
          * \brief Create a new lexeme with a value
          * \param token Token held by the Lexeme
-         * \param val Value of the Lexeme
+         * \param val Value of the Lexeme. It's interned, so the Lexeme doesn't depend on any source
          */
-        explicit Lexeme(Token token, tiny::String val) :token(token), value(std::move(val)) {};
+        explicit Lexeme(Token token, const tiny::Symbol &val) :token(token), value(val.view()) {};
 
         /*!
           * \brief Create a new lexeme with a value and metadata
           * \param token Token held by the Lexeme
-          * \param val Value of the Lexeme
+          * \param val View of the Lexeme's value inside the source buffer. The source must outlive the Lexeme
+          * \param md Metadata of the Lexeme
+          */
+        explicit Lexeme(Token token, std::string_view val, tiny::Metadata md) :token(token), value(val),
+                                                                               metadata(std::move(md)) {};
+
+        /*!
+          * \brief Create a new numeric literal lexeme
+          * \param token Token held by the Lexeme
+          * \param val View of the Lexeme's value inside the source buffer. The source must outlive the Lexeme
+          * \param number The decoded value of the literal
           * \param md Metadata of the Lexeme
           */
-        explicit Lexeme(Token token, tiny::String val, tiny::Metadata md) :token(token), value(std::move(val)),
-                                                                           metadata(std::move(md)) {};
+        explicit Lexeme(Token token, std::string_view val, tiny::Number number, tiny::Metadata md) :token(token),
+                                                                value(val), number(number), metadata(std::move(md)) {};
 
         //! The Token of the lexeme.
         Token token = Token::None;
 
-        //! The optional associated data of the lexeme.
-        tiny::String value;
+        //! The optional associated data of the lexeme. A view into the source buffer that produced it.
+        std::string_view value;
+
+        //! The decoded value of numeric literals. Zero for any other token
+        tiny::Number number;
 
         //! Information of the file that produced the token
         tiny::Metadata metadata;
@@ -192,6 +262,22 @@ namespace tiny {
          */
         [[nodiscard]] std::string string() const;
 
+        /*!
+         * \brief Interns the value of the lexeme
+         * \return A Symbol holding the value, that stays valid after the source is gone
+         */
+        [[nodiscard]] tiny::Symbol getSymbol() const {
+            return tiny::Symbol(value);
+        }
+
+        /*!
+         * \brief Decodes the value of the lexeme into an owned string
+         * \return A tiny::String holding the value
+         */
+        [[nodiscard]] tiny::String getString() const {
+            return tiny::String(value);
+        }
+
         /*!
          * \brief Compares the Lexeme's Token with the one provided
          * \return Whether the Lexeme's and the provided Token are equal
@@ -277,6 +363,24 @@ namespace tiny {
         }
     };
 
+    //! What the Lexer does with trivia (comments)
+    enum class TriviaMode {
+        //! Comments are returned as Lexemes, like any other token
+        Emit,
+        //! Comments are skipped without building anything
+        Skip,
+        //! Comments are skipped, but stored in the Lexer's trivia table
+        Collect,
+    };
+
+    //! What the Lexer does when it finds an invalid program
+    enum class ErrorMode {
+        //! The LexError is thrown
+        Throw,
+        //! The LexError is stored in the Lexer's diagnostics, and lexing goes on from the next safe point
+        Recover,
+    };
+
     //! The Lexer takes a stream of source-code and tokenizes it into lexemes.
     class Lexer {
     public:
@@ -286,10 +390,10 @@ namespace tiny {
         explicit Lexer() = default;
 
         /*!
-         * \brief Builds the Lexer stream from a Stream<char>
-         * \param stream The character stream to feed into the Lexer
+         * \brief Builds the Lexer over a SourceStream
+         * \param stream The source stream to feed into the Lexer
          */
-        explicit Lexer(const tiny::Stream<std::uint32_t> &stream) : s(stream) {};
+        explicit Lexer(const tiny::SourceStream &stream) : s(stream) {};
 
         /*!
          * \brief Builds the lexer stream from an std::istream
@@ -306,7 +410,7 @@ namespace tiny {
         }
 
         //! Holds a table between keywords and their associated token
-        inline static std::map<tiny::String, Token>  KEYWORD_TABLE{
+        inline static constexpr tiny::MatchCase<tiny::Token> KEYWORD_TABLE[] = {
                 // Keywords
                 {"const",    Token::KwConst},
                 {"import",   Token::KwImport},
@@ -365,16 +469,20 @@ namespace tiny {
                 {"False",    Token::LiteralFalse},
         };
 
+        //! Looks up identifiers in KEYWORD_TABLE with a single hash and comparison
+        inline static constexpr tiny::PerfectHash<tiny::Token, 128> KEYWORD_HASH{KEYWORD_TABLE, Token::None};
+
         /*!
          * \brief Runs the lexer until a lexeme can be returned
          * \return A single Lexeme that might be empty
          *
          * Runs the lexer until a lexeme can be returned. In some cases a none-value Lexeme will be returned (for
-         * example if there's still unlexed chars, but the remainder are just blanks). The caller should make sure the
-         * returned value is valid. The stream's position will be advanced according to the lexed characters.
+         * example if there's still unlexed chars, but the remainder are just blanks, or a comment was skipped). The
+         * caller should make sure the returned value is valid. The stream's position will be advanced according to the
+         * lexed characters.
          *
          * If the Lexer encounters an invalid program or an unknown character the LexError exception is thrown with
-         * a description of the error.
+         * a description of the error. In ErrorMode::Recover the error is stored instead, and a None Lexeme is returned.
          */
         [[nodiscard]] Lexeme lex();
 
@@ -390,60 +498,171 @@ namespace tiny {
          */
         [[nodiscard]] std::vector<Lexeme> lexAll();
 
+        /*!
+         * \brief Lexes the stream until the end into a TokenBuffer
+         * \return A TokenBuffer with all the tokenizable Lexemes in the stream
+         *
+         * Works like lexAll, but stores the Lexemes compactly in a TokenBuffer instead of a vector of Lexemes.
+         */
+        [[nodiscard]] tiny::TokenBuffer tokenize();
+
+        /*!
+         * \brief Lexes the stream until the end into a TokenBuffer, using multiple threads
+         * \param threads The number of threads to use. Zero uses one per core
+         * \param minChunk The smallest number of bytes worth giving to a thread
+         * \return The same TokenBuffer tokenize would return
+         *
+         * Splits the rest of the source at newlines into one chunk per thread and lexes the chunks concurrently, each
+         * one as if it started at a token boundary. Since a chunk can start inside a string literal or a multiline
+         * comment, chunks are stitched in order: the tokens of a chunk are only taken from the point where the lexing
+         * of the previous ones ended, and if that isn't one of the chunk's token boundaries the chunk is lexed again
+         * from there until it syncs up. Offsets are always relative to the whole source, so no fix-up is needed.
+         *
+         * Trivia and errors are handled according to the TriviaMode and ErrorMode. Errors are thrown as tokenize would:
+         * the first LexError of the file, in source order. Sources too small to split are lexed by tokenize on the
+         * calling thread.
+         */
+        [[nodiscard]] tiny::TokenBuffer tokenizeParallel(unsigned threads = 0, std::size_t minChunk = 1 << 16);
+
+        /*!
+         * \brief Lexes again the part of an edited source affected by an edit
+         * \param tokens The tokens of the source before the edit, as returned by tokenize
+         * \param edit The edit that turned the old source into the Lexer's source
+         * \return The same TokenBuffer tokenize would return for the Lexer's source
+         *
+         * The Lexer must be over the edited source. Lexing restarts at the last token that starts before the edit, and
+         * goes on until a token that starts after the inserted text is also in the old tokens, moved by the edit's
+         * shift. From there on both lexings would be the same, so the rest of the old tokens are moved over instead of
+         * lexed. Only the offsets of the old tokens are used, so the old source doesn't need to be alive.
+         *
+         * The old tokens must have been lexed with the same TriviaMode and ErrorMode. In TriviaMode::Collect and
+         * ErrorMode::Recover only the comments and errors of the re-lexed part are stored. The stream's position is
+         * advanced to the end, and errors are thrown as lex does.
+         */
+        [[nodiscard]] tiny::TokenBuffer relex(const tiny::TokenBuffer &tokens, const tiny::TextEdit &edit);
+
         /*!
          * \brief Basic token constructs used by the lexer and their Token
          *
          * Contains the basic token constructs used by the lexer and their Token. Not all cases are addressed, but most
-         * single- and double- character token constructs are included.
-         */
-        const std::map<std::vector<std::uint32_t>, tiny::Token> TOKEN_TABLE{
-                {{','},      Token::Comma},
-                {{'+', '='}, Token::AssignSum},
-                {{'+'},      Token::Sum},
-                {{'-', '='}, Token::AssignSub},
-                {{'-'},      Token::Sub},
-                {{'*', '='}, Token::AssignMulti},
-                {{'*', '*'}, Token::Exp},
-                {{'*'},      Token::Multi},
-                {{'('},      Token::OParenthesis},
-                {{')'},      Token::CParenthesis},
-                {{'{'},      Token::OBraces},
-                {{'}'},      Token::CBraces},
-                {{'['},      Token::OBrackets},
-                {{']'},      Token::CBrackets},
-                {{':', '='}, Token::Init},
-                {{'.'},      Token::MemberAccess},
-                {{'>', '='}, Token::Gteq},
-                {{'>'},      Token::Gt},
-                {{'<', '='}, Token::Lteq},
-                {{'<'},      Token::Lt},
-                {{'=', '='}, Token::Eq},
-                {{'='},      Token::Assign},
-                {{'/', '/'}, Token::SinglelineComment},
-                {{'/', '*'}, Token::MultilineComment},
-                {{'/', '='}, Token::AssignDiv},
-                {{'/'},      Token::Div},
-                {{'!', '!'}, Token::Doublebang},
-                {{'!', '='}, Token::Neq},
-                {{'!'},      Token::Negation},
-                {{'.', '.'}, Token::Range},
-                {{'-', '>'}, Token::Step},
-                {{'&'},      Token::Dereference},
-                {{'$'},      Token::ValueAt},
+         * single- and double- character token constructs are included. The table is compiled into OPERATOR_MATCHER.
+         */
+        inline static constexpr tiny::MatchCase<tiny::Token> OPERATOR_TABLE[] = {
+                {",",  Token::Comma},
+                {"+=", Token::AssignSum},
+                {"+",  Token::Sum},
+                {"-=", Token::AssignSub},
+                {"-",  Token::Sub},
+                {"*=", Token::AssignMulti},
+                {"**", Token::Exp},
+                {"*",  Token::Multi},
+                {"(",  Token::OParenthesis},
+                {")",  Token::CParenthesis},
+                {"{",  Token::OBraces},
+                {"}",  Token::CBraces},
+                {"[",  Token::OBrackets},
+                {"]",  Token::CBrackets},
+                {":=", Token::Init},
+                {".",  Token::MemberAccess},
+                {">=", Token::Gteq},
+                {">",  Token::Gt},
+                {"<=", Token::Lteq},
+                {"<",  Token::Lt},
+                {"==", Token::Eq},
+                {"=",  Token::Assign},
+                {"//", Token::SinglelineComment},
+                {"/*", Token::MultilineComment},
+                {"/=", Token::AssignDiv},
+                {"/",  Token::Div},
+                {"!!", Token::Doublebang},
+                {"!=", Token::Neq},
+                {"!",  Token::Negation},
+                {"..", Token::Range},
+                {"->", Token::Step},
+                {"&",  Token::Dereference},
+                {"$",  Token::ValueAt},
         };
 
+        //! Longest-match automaton over OPERATOR_TABLE, built at compile time
+        inline static constexpr tiny::Matcher<tiny::Token, tiny::countStates(OPERATOR_TABLE)> OPERATOR_MATCHER{
+                OPERATOR_TABLE, Token::None};
+
+        /*!
+         * \brief Sets the file to be included in the metadata of the generated Lexemes
+         * \param f The id of the file in the SourceManager
+         */
+        void setMetadataFile(tiny::FileId f);
+
+        /*!
+         * \brief Gets the file included in the metadata of the generated Lexemes
+         * \return The id of the file set by setMetadataFile
+         */
+        [[nodiscard]] tiny::FileId getMetadataFile() const {
+            return file;
+        }
+
+        /*!
+         * \brief Gets the source being lexed
+         * \return The Source the Lexemes' values point into
+         */
+        [[nodiscard]] const tiny::Source &getSource() const {
+            return s.getSource();
+        }
+
+        /*!
+         * \brief Sets what to do with the comments found from now on
+         * \param mode The TriviaMode. Lexers start in TriviaMode::Emit
+         */
+        void setTriviaMode(tiny::TriviaMode mode) {
+            triviaMode = mode;
+        }
+
+        /*!
+         * \brief Gets what is done with the comments
+         * \return The TriviaMode set by setTriviaMode
+         */
+        [[nodiscard]] tiny::TriviaMode getTriviaMode() const {
+            return triviaMode;
+        }
+
+        /*!
+         * \brief Gets the comments collected so far
+         * \return The comments found while in TriviaMode::Collect, in source order
+         */
+        [[nodiscard]] const std::vector<tiny::Lexeme> &getTrivia() const {
+            return trivia;
+        }
+
+        /*!
+         * \brief Sets what to do with the errors found from now on
+         * \param mode The ErrorMode. Lexers start in ErrorMode::Throw
+         */
+        void setErrorMode(tiny::ErrorMode mode) {
+            errorMode = mode;
+        }
+
+        /*!
+         * \brief Gets what is done with the errors
+         * \return The ErrorMode set by setErrorMode
+         */
+        [[nodiscard]] tiny::ErrorMode getErrorMode() const {
+            return errorMode;
+        }
+
         /*!
-         * \brief Sets the filename to be included in the metadata of the generated Lexemes
-         * \param f The file's path
+         * \brief Gets the errors found so far
+         * \return The errors found while in ErrorMode::Recover, in source order
          */
-        void setMetadataFile(tiny::File f);
+        [[nodiscard]] const std::vector<tiny::LexError> &getDiagnostics() const {
+            return diagnostics;
+        }
 
     private:
         //! The stream terminator used by the Lexer
         static const char StreamTerminator = '\0';
 
         //! The source-code stream
-        tiny::Stream<std::uint32_t> s{};
+        tiny::SourceStream s{};
 
         /*!
          * \brief Lexes an identifier from the stream
@@ -457,8 +676,9 @@ namespace tiny {
          * \brief Lexes a numeric literal from the stream
          * \return A Lexeme containing the numeric literal
          *
-         * Lexes a numeric literal from the stream. If an invalid numeric literal is encountered the LexError exception
-         * is thrown
+         * Lexes a numeric literal from the stream and decodes its value. Integers are decoded as an int64, or as an
+         * uint64 if they're too big for it, and decimals as a long double. If an invalid numeric literal is
+         * encountered, or its value doesn't fit in any of those types, the LexError exception is thrown
          */
         Lexeme lexNumericLiteral();
 
@@ -480,11 +700,54 @@ namespace tiny {
          */
         Lexeme lexCharLiteral();
 
-        //! File that originated the lexemes
-        tiny::File file;
+        /*!
+         * \brief Lexes the next token, throwing on any error
+         * \return A single Lexeme that might be empty, as returned by lex
+         */
+        Lexeme next();
+
+        /*!
+         * \brief Moves the stream to the next safe point after an error
+         * \param error Metadata of the error
+         *
+         * Unterminated string and char literals resume at the end of their line instead of swallowing the rest of the
+         * source, and malformed numeric literals are skipped as a whole. Otherwise the stream is left where the error
+         * was found, or past the offending codepoint.
+         */
+        void recover(const tiny::Metadata &error);
+
+        //! Id of the file that originated the lexemes
+        tiny::FileId file = 0;
+
+        //! What to do with comments
+        tiny::TriviaMode triviaMode = tiny::TriviaMode::Emit;
+
+        //! Comments collected in TriviaMode::Collect
+        std::vector<tiny::Lexeme> trivia;
+
+        //! What to do with errors
+        tiny::ErrorMode errorMode = tiny::ErrorMode::Throw;
+
+        //! Errors stored in ErrorMode::Recover
+        std::vector<tiny::LexError> diagnostics;
+
+        /*!
+         * \brief Hands a comment over according to the TriviaMode
+         * \param comment The comment
+         * \return The comment in TriviaMode::Emit, or a None Lexeme otherwise
+         */
+        Lexeme trivium(Lexeme comment);
 
         //! Current token's metadata
         [[nodiscard]] tiny::Metadata getMetadata() const;
+
+        /*!
+         * \brief Gets a view over a range of the source
+         * \param from Byte offset of the start of the range
+         * \param to Byte offset of the end of the range (exclusive)
+         * \return A view over the bytes in the range
+         */
+        [[nodiscard]] std::string_view slice(std::uint64_t from, std::uint64_t to) const;
     };
 }
 
@@ -0,0 +1,246 @@
+#ifndef TINY_MATCHER_H
+#define TINY_MATCHER_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace tiny {
+    //! An entry of a Matcher's table: an ASCII spelling and the value it produces.
+    template<typename Result>
+    struct MatchCase {
+        //! The sequence of ASCII characters to match
+        std::string_view seq;
+
+        //! The value produced when the sequence matches
+        Result result;
+    };
+
+    //! Number of entries in the table
+    template<typename Result, std::size_t N>
+    /*!
+     * \brief Counts the states needed by a Matcher over a table
+     * \param cases The table of the Matcher
+     * \return An upper bound of the number of states: one for the start plus one per character in the table
+     */
+    constexpr std::size_t countStates(const tiny::MatchCase<Result> (&cases)[N]) {
+        std::size_t states = 1;
+        for (std::size_t i = 0; i < N; i++) {
+            states += cases[i].seq.size();
+        }
+
+        return states;
+    }
+
+    //! The value produced by the matched sequences
+    template<typename Result, std::size_t States>
+    /*!
+     * \brief A Matcher is a longest-match automaton over a table of ASCII sequences, built at compile time
+     *
+     * A Matcher is a trie-shaped DFA built from a table of ASCII sequences. Each state has a transition table indexed
+     * by the next byte, so matching walks the input one byte at a time without comparing against every entry nor
+     * allocating, and remembers the last accepting state to return the longest match. Tables are meant to be
+     * declared constexpr so the automaton is built by the compiler; an invalid table (non-ASCII or duplicated
+     * sequences) fails to compile.
+     */
+    class Matcher {
+        static_assert(States <= 256, "States are stored in a byte");
+
+    public:
+        //! Number of entries in the table
+        template<std::size_t N>
+        /*!
+         * \brief Builds the automaton for a table
+         * \param cases The table of sequences and their values
+         * \param none The value returned when nothing matches
+         */
+        constexpr explicit Matcher(const tiny::MatchCase<Result> (&cases)[N], Result none) : none(none) {
+            std::size_t used = 1;
+
+            for (std::size_t c = 0; c < N; c++) {
+                if (cases[c].seq.empty()) {
+                    throw std::invalid_argument("Empty sequence in Matcher table");
+                }
+
+                std::size_t state = 0;
+                for (char ch: cases[c].seq) {
+                    auto byte = static_cast<unsigned char>(ch);
+                    if (byte >= 128) {
+                        throw std::invalid_argument("Non-ASCII sequence in Matcher table");
+                    }
+
+                    if (transitions[state][byte] == 0) {
+                        transitions[state][byte] = std::uint8_t(used++);
+                    }
+
+                    state = transitions[state][byte];
+                }
+
+                if (accepting[state]) {
+                    throw std::invalid_argument("Duplicated sequence in Matcher table");
+                }
+
+                accepting[state] = true;
+                results[state] = cases[c].result;
+            }
+        }
+
+        /*!
+         * \brief Finds the longest sequence of the table at the start of the input
+         * \param bytes The input
+         * \return A pair of the matched value and the length of the matched sequence. If nothing matches the value is
+         * the none value given on construction and the length is 0
+         */
+        [[nodiscard]] constexpr std::pair<Result, std::size_t> match(std::string_view bytes) const {
+            Result best = none;
+            std::size_t bestLength = 0;
+
+            std::size_t state = 0;
+            for (std::size_t i = 0; i < bytes.size(); i++) {
+                auto byte = static_cast<unsigned char>(bytes[i]);
+                if (byte >= 128) {
+                    break;
+                }
+
+                state = transitions[state][byte];
+                if (state == 0) {
+                    break; // The start state is never a target, so 0 means there's no transition
+                }
+
+                if (accepting[state]) {
+                    best = results[state];
+                    bestLength = i + 1;
+                }
+            }
+
+            return {best, bestLength};
+        }
+
+    private:
+        //! Next state for each state and ASCII byte. 0 means there's no transition
+        std::array<std::array<std::uint8_t, 128>, States> transitions{};
+
+        //! Whether reaching a state completes a sequence
+        std::array<bool, States> accepting{};
+
+        //! The value of each accepting state
+        std::array<Result, States> results{};
+
+        //! Value returned when nothing matches
+        Result none;
+    };
+
+    //! The value produced by the matched sequences
+    template<typename Result, std::size_t Slots>
+    /*!
+     * \brief A PerfectHash maps a table of ASCII sequences to their values with a collision-free compile-time hash
+     *
+     * A PerfectHash looks up whole sequences (like keywords) rather than prefixes. The hash only mixes the length and
+     * the first, middle and last bytes of the input, and the constructor searches for a seed under which no two
+     * sequences of the table share a slot. A lookup is then a single hash and a single comparison against the slot's
+     * sequence, and any input that's shorter or longer than every sequence is rejected before hashing. Tables are meant
+     * to be declared constexpr; if no seed is found (or the table is invalid) it fails to compile.
+     */
+    class PerfectHash {
+        static_assert(Slots > 0 && (Slots & (Slots - 1)) == 0, "The number of slots must be a power of two");
+
+    public:
+        //! Number of entries in the table
+        template<std::size_t N>
+        /*!
+         * \brief Searches a seed and fills the slots for a table
+         * \param cases The table of sequences and their values
+         * \param none The value returned when nothing matches
+         */
+        constexpr explicit PerfectHash(const tiny::MatchCase<Result> (&cases)[N], Result none) : none(none) {
+            static_assert(N <= Slots, "More sequences than slots");
+
+            for (std::size_t c = 0; c < N; c++) {
+                if (cases[c].seq.empty()) {
+                    throw std::invalid_argument("Empty sequence in PerfectHash table");
+                }
+
+                minLength = std::min(minLength, cases[c].seq.size());
+                maxLength = std::max(maxLength, cases[c].seq.size());
+            }
+
+            for (seed = 1; seed < MAX_SEED; seed++) {
+                slots = {};
+
+                bool collision = false;
+                for (std::size_t c = 0; c < N && !collision; c++) {
+                    auto &slot = slots[index(cases[c].seq, seed)];
+                    collision = !slot.seq.empty();
+                    slot = cases[c];
+                }
+
+                if (!collision) {
+                    return;
+                }
+            }
+
+            throw std::invalid_argument("No collision-free seed for PerfectHash table");
+        }
+
+        /*!
+         * \brief Looks up a sequence
+         * \param bytes The whole sequence to look up
+         * \return The value of the sequence or the none value given on construction if it's not on the table
+         */
+        [[nodiscard]] constexpr Result find(std::string_view bytes) const {
+            if (bytes.size() < minLength || bytes.size() > maxLength) {
+                return none;
+            }
+
+            const auto &slot = slots[index(bytes, seed)];
+            if (slot.seq != bytes) {
+                return none;
+            }
+
+            return slot.result;
+        }
+
+    private:
+        //! Seeds to try before giving up
+        static constexpr std::uint32_t MAX_SEED = 1 << 16;
+
+        /*!
+         * \brief Hashes a non-empty sequence into a slot
+         * \param bytes Sequence to hash
+         * \param seed Seed of the hash
+         * \return The index of the slot
+         */
+        static constexpr std::size_t index(std::string_view bytes, std::uint32_t seed) {
+            std::uint32_t hash = seed;
+            for (auto mix: {std::uint32_t(bytes.size()),
+                            std::uint32_t(static_cast<unsigned char>(bytes.front())),
+                            std::uint32_t(static_cast<unsigned char>(bytes[bytes.size() / 2])),
+                            std::uint32_t(static_cast<unsigned char>(bytes.back()))}) {
+                hash = (hash ^ mix) * 0x01000193;
+            }
+
+            return (hash ^ (hash >> 16)) & (Slots - 1);
+        }
+
+        //! The sequence and value stored on each slot. Empty slots have an empty sequence
+        std::array<tiny::MatchCase<Result>, Slots> slots{};
+
+        //! Seed under which the table has no collisions
+        std::uint32_t seed = 0;
+
+        //! Length of the shortest sequence
+        std::size_t minLength = SIZE_MAX;
+
+        //! Length of the longest sequence
+        std::size_t maxLength = 0;
+
+        //! Value returned when nothing matches
+        Result none;
+    };
+}
+
+#endif //TINY_MATCHER_H
@@ -1,27 +1,9 @@
 #include "metadata.h"
 #include "stringutil.h"
 
-std::pair<std::uint64_t, std::uint64_t> tiny::Metadata::getPosition(tiny::Stream<std::uint32_t> &s) const {
-    std::uint64_t line = 1;
-    std::uint64_t col = 1;
-
-    while (s.getIndex() < start && s) {
-        if (s.get() == '\n') {
-            line++;
-            col = 1;
-
-            continue;
-        }
-
-        col++;
-    }
-
-    return {line, col};
-}
-
 std::pair<std::string, std::int32_t>
-tiny::Metadata::getContext(tiny::Stream<std::uint32_t> &s, std::int32_t range) const {
-    unsigned long prevState = s.getIndex(); // Save the index to restore it latter
+tiny::Metadata::getContext(std::int32_t range) const {
+    tiny::SourceStream s(tiny::SourceManager::get().getSource(file));
 
     // Start from the character that generated the error
     s.seek(start);
@@ -52,10 +34,6 @@ tiny::Metadata::getContext(tiny::Stream<std::uint32_t> &s, std::int32_t range) c
         context += got;
     }
 
-    // Restore the stream's index
-    s.seek(prevState);
-
-
     auto ctxStr = context.toString();
     auto prevLength = std::int32_t(ctxStr.length());
 
@@ -1,45 +1,54 @@
 #ifndef TINY_METADATA_H
 #define TINY_METADATA_H
 
-#include "stream.h"
+#include "source.h"
 #include "unicode.h"
 #include "file.h"
+#include "sourcemanager.h"
 
 namespace tiny {
-    //! The Metadata struct contains information regarding the character's stream information
+    //! The Metadata struct contains information regarding the character's stream information: a span inside a file
     struct Metadata {
         //! Empty constructor for the metadata
         Metadata() = default;
 
         /*!
          * \brief Constructor with the start and end positions
-         * \param fn The file
+         * \param f The id of the file in the SourceManager
          * \param startPos The index at which the metadata points
          * \param endPos The index at which the metadata stops
          */
-        explicit Metadata(const tiny::File &f, std::uint64_t startPos, std::uint64_t endPos) :file(f),
-                                                                                       start(startPos),
-                                                                                       end(endPos) {};
+        explicit Metadata(tiny::FileId f, std::uint64_t startPos, std::uint64_t endPos) :file(f),
+                                                                                 start(startPos),
+                                                                                 end(endPos) {};
 
-        //! File from which the character proceeds from
-        tiny::File file;
+        //! Id of the file from which the character proceeds from
+        tiny::FileId file = 0;
 
-        //! Index of the token start
+        //! Byte offset of the token start
         std::uint64_t start = 0;
 
-        //! Index of the token end
+        //! Byte offset of the token end
         std::uint64_t end = 0;
 
         /*!
-         * \brief Returns the position of the metadata inside the provided stream [line, column] pair
-         * \param s Stream in which the position is calculated
+         * \brief Gets the file from which the character proceeds from
+         * \return The file, as registered in the SourceManager
+         */
+        [[nodiscard]] const tiny::File &getFile() const {
+            return tiny::SourceManager::get().getFile(file);
+        }
+
+        /*!
+         * \brief Returns the position of the metadata inside its file as a [line, column] pair
          * \return A [line, column] index pair
          */
-        [[nodiscard]] std::pair<std::uint64_t, std::uint64_t> getPosition(tiny::Stream<std::uint32_t> &s) const;
+        [[nodiscard]] std::pair<std::uint64_t, std::uint64_t> getPosition() const {
+            return tiny::SourceManager::get().getPosition(file, start);
+        }
 
         /*!
          * \brief Returns the context around the error and the position of the error in the context
-         * \param s Stream in which the error was generated
          * \param range Optional maximum length of the context. Defaults to 100
          * \return A [context, error position] pair
          *
@@ -48,7 +57,7 @@ namespace tiny {
          * error position. So a maximum of 2/range - len(error) characters will be to either side of the error string.
          */
         [[nodiscard]] std::pair<std::string, std::int32_t>
-        getContext(tiny::Stream<std::uint32_t> &s, std::int32_t range = 100) const;
+        getContext(std::int32_t range = 100) const;
 
         /*!
          * \brief Returns the length between the start and end positions
@@ -3,7 +3,7 @@
 
 #include <utility>
 
-tiny::Lexeme tiny::Parser::consume(const tiny::Token &token) {
+tiny::TokenRef tiny::Parser::consume(const tiny::Token &token) {
     auto got = s.get();
 
     if (s.isTerminator(got)) {
@@ -14,7 +14,7 @@ tiny::Lexeme tiny::Parser::consume(const tiny::Token &token) {
     if (token != got.token) {
         throw tiny::ParseError(
                 "Unexpected token: expected " + tiny::Lexeme(token).string() + " but got " + got.string(),
-                got.metadata);
+                got.getMetadata());
     }
 
     return got;
@@ -33,9 +33,9 @@ void tiny::Parser::exhaust(tiny::Token token) {
     while (consumeOptional(token));
 }
 
-void tiny::Parser::exhaust(const std::vector<tiny::Token> &tokens) {
-    while (std::find(tokens.begin(), tokens.end(), s.peek().token) != tokens.end()) {
-        exhaust(s.peek().token);
+void tiny::Parser::exhaust(tiny::TokenSet tokens) {
+    while (tokens.contains(s.peek().token)) {
+        s.skip();
     }
 }
 
@@ -48,6 +48,50 @@ bool tiny::Parser::check(tiny::Token token) {
     return true;
 }
 
+/*
+ *  Lookahead for <Identifier> := ... '..' up to the end of the for header
+ */
+bool tiny::Parser::checkRangeExpression() {
+    if (!check(tiny::Token::Id) || s.peek(1) != tiny::Token::Init) {
+        return false;
+    }
+
+    for (std::uint64_t i = 2;; i++) {
+        auto next = s.peek(i);
+        if (s.isTerminator(next) || next == tiny::Token::OBraces || next == tiny::Token::NewLine) {
+            return false;
+        }
+
+        if (next == tiny::Token::Range) {
+            return true;
+        }
+    }
+}
+
+/*
+ *  Lookahead for (const) [*|&|e][<Identifier>|BUILTIN_TYPE] <Identifier>
+ *            and (const) $<Identifier> <Identifier> if allowValueAt is set
+ */
+bool tiny::Parser::checkTypedExpression(bool allowValueAt) {
+    std::uint64_t i = 0;
+    if (s.peek(i) == tiny::Token::KwConst) {
+        i++;
+    }
+
+    auto modifier = s.peek(i).token;
+    auto isValueAt = allowValueAt && modifier == tiny::Token::ValueAt;
+    if (isValueAt || modifier == tiny::Token::Multi || modifier == tiny::Token::Dereference) {
+        i++;
+    }
+
+    auto type = s.peek(i);
+    if (type != tiny::Token::Id && (isValueAt || !type.isType())) {
+        return false;
+    }
+
+    return s.peek(i + 1) == tiny::Token::Id;
+}
+
 /*
  *  File ::= <StatementList>
  *     -> Imports
@@ -57,17 +101,20 @@ tiny::ASTFile tiny::Parser::file(tiny::File file, bool requireModule) {
     auto mod = moduleStatement(!requireModule);
     auto imprts = importStatement();
 
+    auto statements = statementList();
+
     return tiny::ASTFile(
             file,
             mod,
             imprts,
-            statementList());
+            std::move(arena),
+            std::move(statements));
 }
 
 /*
  *  ModuleStatement ::= module STRING
  */
-tiny::String tiny::Parser::moduleStatement(bool optional) {
+tiny::Symbol tiny::Parser::moduleStatement(bool optional) {
     exhaust(SKIPABLE_TOKENS);
 
     if (!consumeOptional(tiny::Token::KwModule)) {
@@ -78,7 +125,7 @@ tiny::String tiny::Parser::moduleStatement(bool optional) {
         throw tiny::ParseError("No module name defined", getMetadata());
     }
 
-    return consume(tiny::Token::Id).value;
+    return consume(tiny::Token::Id).getSymbol();
 }
 
 /*
@@ -97,11 +144,11 @@ std::vector<tiny::Import> tiny::Parser::importStatement() {
     while (true) {
         exhaust(SKIPABLE_TOKENS);
 
-        tiny::Import imprt(consume(tiny::Token::Id).value);
+        tiny::Import imprt(consume(tiny::Token::Id).getSymbol());
 
         // Import alias?
         if (consumeOptional(tiny::Token::KwAs)) {
-            imprt.alias = consume(tiny::Token::Id).value;
+            imprt.alias = consume(tiny::Token::Id).getSymbol();
         }
 
         imports.push_back(imprt);
@@ -129,7 +176,7 @@ tiny::StatementList tiny::Parser::statementList(tiny::Token stopToken) {
         }
 
         exhaust(SKIPABLE_TOKENS);
-        statements.push_back(statement({tiny::Token::NewLine, stopToken}));
+        statements.push_back(statement({tiny::Token::NewLine, stopToken}).getId());
         exhaust(SKIPABLE_TOKENS);
     }
 
@@ -144,7 +191,7 @@ tiny::StatementList tiny::Parser::statementList(tiny::Token stopToken) {
  *             |  <ForStatement>
  *             |  <ReturnStatement>
  */
-tiny::ASTNode tiny::Parser::statement(std::vector<tiny::Token> terminators) {
+tiny::NodeRef tiny::Parser::statement(tiny::TokenSet terminators) {
     switch (s.peek().token) {
         case tiny::Token::OBraces:
             return errorHandledBlockStatement();
@@ -166,7 +213,7 @@ tiny::ASTNode tiny::Parser::statement(std::vector<tiny::Token> terminators) {
             throw tiny::ParseError("Import statements can only be placed immediately after the module name",
                                    getMetadata());
         default:
-            return expressionStatement(std::move(terminators));
+            return expressionStatement(terminators);
     }
 }
 
@@ -174,7 +221,7 @@ tiny::ASTNode tiny::Parser::statement(std::vector<tiny::Token> terminators) {
  *  ErrorHandledBlockStatement ::= <BlockStatement> !! <Identifier> <BlockStatement>
  *                             |   <BlockStatement>
  */
-tiny::ASTNode tiny::Parser::errorHandledBlockStatement() {
+tiny::NodeRef tiny::Parser::errorHandledBlockStatement() {
     auto lhs = blockStatement();
 
     if (consumeOptional(tiny::Token::Doublebang)) {
@@ -183,18 +230,18 @@ tiny::ASTNode tiny::Parser::errorHandledBlockStatement() {
         if (check(tiny::Token::OBraces)) {
             // Inlined block handle
             auto stmt = blockStatement();
-            auto node = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::ErrorHandle, lhs, stmt);
+            auto node = make(tiny::ASTNodeType::ErrorHandle, lhs, stmt);
 
-            auto varNameParam = tiny::Parameter(tiny::ParameterType::ErrorVarName, id.value);
+            auto varNameParam = tiny::Parameter(tiny::ParameterType::ErrorVarName, id.getSymbol());
             node.addParam(varNameParam);
 
             return node;
         }
 
         // Callback handler
-        auto node = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::ErrorHandle, lhs);
+        auto node = make(tiny::ASTNodeType::ErrorHandle, lhs);
 
-        auto callbackName = tiny::Parameter(tiny::ParameterType::ErrorCallback, id.value);
+        auto callbackName = tiny::Parameter(tiny::ParameterType::ErrorCallback, id.getSymbol());
         node.addParam(callbackName);
 
         return node;
@@ -206,11 +253,11 @@ tiny::ASTNode tiny::Parser::errorHandledBlockStatement() {
 /*
  *  BlockStatement ::= { (\n*) ([<ExpressionStatement>\n|\n]*) } (\n*)
  */
-tiny::ASTNode tiny::Parser::blockStatement() {
+tiny::NodeRef tiny::Parser::blockStatement() {
     consume(tiny::Token::OBraces);
     exhaust(tiny::Token::NewLine);
 
-    tiny::ASTNode exp(getMetadata(), tiny::ASTNodeType::BlockStatement);
+    auto exp = make(tiny::ASTNodeType::BlockStatement);
     exp.addChildren(statementList(tiny::Token::CBraces));
     exhaust(tiny::Token::NewLine);
 
@@ -221,107 +268,99 @@ tiny::ASTNode tiny::Parser::blockStatement() {
  *  IfStatement ::= if (\n*) <ExpressionStatement> { (\n*) <Statement>*) } (\n*)
  *               |  if (\n*) <ExpressionStatement> { (\n*) <Statement>*) } (\n*) else (\n*) { (\n*) <Statement>*) } (\n*)
  */
-tiny::ASTNode tiny::Parser::ifStatement() {
+tiny::NodeRef tiny::Parser::ifStatement() {
     consume(tiny::Token::KwIf);
     exhaust(tiny::Token::NewLine);
 
     auto exp = expression();
-    auto condition = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::BranchCondition, exp);
+    auto condition = make(tiny::ASTNodeType::BranchCondition, exp);
 
     exhaust(tiny::Token::NewLine);
     auto stmt = blockStatement();
-    auto consequent = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::BranchConsequent, stmt);
+    auto consequent = make(tiny::ASTNodeType::BranchConsequent, stmt);
     exhaust(tiny::Token::NewLine);
 
     if (!consumeOptional(tiny::Token::KwElse)) {
         // No else
-        return tiny::ASTNode(getMetadata(), tiny::ASTNodeType::IfStatement, condition, consequent);
+        return make(tiny::ASTNodeType::IfStatement, condition, consequent);
     }
 
     exhaust(tiny::Token::NewLine);
     stmt = blockStatement();
-    auto alternative = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::BranchAlternative, stmt);
+    auto alternative = make(tiny::ASTNodeType::BranchAlternative, stmt);
     exhaust(tiny::Token::NewLine);
 
-    return tiny::ASTNode(getMetadata(), tiny::ASTNodeType::IfStatement, condition, consequent, alternative);
+    return make(tiny::ASTNodeType::IfStatement, condition, consequent, alternative);
 }
 
 
 /*
  *  ForStatement ::= for (\n*) [<RangeExpression>|<ForEachExpression>|<Expression>|""] { (\n*) <Statement>+) } (\n*)
  */
-tiny::ASTNode tiny::Parser::forStatement() {
+tiny::NodeRef tiny::Parser::forStatement() {
     consume(tiny::Token::KwFor);
     exhaust(tiny::Token::NewLine);
 
-    tiny::ASTNode conditionDownstream;
-    std::uint64_t streamCheckpoint = s.getIndex();
+    tiny::NodeRef conditionDownstream;
 
-    // Try each of the possible expressions that can go inside the for. For correctly predicting this choice
-    // more than L(1) is needed; thus we try the for-specific expressions in order and else default to a
-    // generic Expression node.
+    // Predict which of the possible expressions goes inside the for. A for-each starts as "<Identifier> in", while
+    // both a range and an initialization start as "<Identifier> :=", so a range is only told apart by the '..' that
+    // follows its first operand.
     if (check(tiny::Token::OBraces)) {
         // Empty for (infinite loop). Equivalent to "for true {}"
 
-        conditionDownstream = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::LiteralBool);
-        conditionDownstream.val = true;
+        conditionDownstream = make(tiny::ASTNodeType::LiteralBool);
+        conditionDownstream->val = true;
 
+    } else if (check(tiny::Token::Id) && s.peek(1) == tiny::Token::KwIn) {
+        conditionDownstream = forEachExpression();
+    } else if (checkRangeExpression()) {
+        conditionDownstream = rangeExpression();
     } else {
-        try {
-            conditionDownstream = rangeExpression();
-        } catch (tiny::ParseError &) {
-            s.seek(streamCheckpoint);
-            try {
-                conditionDownstream = forEachExpression();
-            } catch (tiny::ParseError &) {
-                s.seek(streamCheckpoint);
-                conditionDownstream = expression();
-
-                // Don't catch the last one, since if it fails the for is malformed and the error should propagate
-            }
-        }
+        conditionDownstream = expression();
     }
 
-
-    auto condition = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::BranchCondition, conditionDownstream);
+    auto condition = make(tiny::ASTNodeType::BranchCondition, conditionDownstream);
 
     exhaust(tiny::Token::NewLine);
     auto stmt = blockStatement();
-    auto consequent = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::BranchConsequent, stmt);
+    auto consequent = make(tiny::ASTNodeType::BranchConsequent, stmt);
     exhaust(tiny::Token::NewLine);
 
-    return tiny::ASTNode(getMetadata(), tiny::ASTNodeType::ForStatement, condition, consequent);
+    return make(tiny::ASTNodeType::ForStatement, condition, consequent);
 }
 
 /*
  *  RangeExpression ::= <Identifier> := <AdditiveExpression>..(<AdditiveExpression>) (-> <AdditiveExpression>)
+ *
+ *  AdditiveExpression is a BinaryExpression of at least ADDITIVE_POWER
  */
-tiny::ASTNode tiny::Parser::rangeExpression() {
-    tiny::ASTNode node(getMetadata(), tiny::ASTNodeType::RangeExpression);
+tiny::NodeRef tiny::Parser::rangeExpression() {
+    auto node = make(tiny::ASTNodeType::RangeExpression);
 
     auto id = consume(tiny::Token::Id);
-    node.addParam(tiny::Parameter(tiny::ParameterType::RangeIdentifier, id.value));
+    node.addParam(tiny::Parameter(tiny::ParameterType::RangeIdentifier, id.getSymbol()));
 
     consume(tiny::Token::Init);
 
     // Don't accept anything upstream from additive since it might involve non-numeric operands
-    auto exp = additiveExpression();
-    node.addChildren(tiny::ASTNode(getMetadata(), tiny::ASTNodeType::RangeFromExpression, exp)); // From
+    auto exp = binaryExpression(ADDITIVE_POWER);
+    node.addChildren(make(tiny::ASTNodeType::RangeFromExpression, exp)); // From
     consume(tiny::Token::Range);
 
     exhaust(tiny::Token::NewLine);
     if (!check(tiny::Token::OBraces) && !check(tiny::Token::Step)) {
-        exp = additiveExpression();
-        node.addChildren(tiny::ASTNode(getMetadata(), tiny::ASTNodeType::RangeToExpression, exp)); // To
+        exp = binaryExpression(ADDITIVE_POWER);
+        node.addChildren(make(tiny::ASTNodeType::RangeToExpression, exp)); // To
     } else {
-        node.addChildren(tiny::ASTNode(getMetadata(), tiny::ASTNodeType::RangeToExpression)); // Placeholder to
+        node.addChildren(make(tiny::ASTNodeType::RangeToExpression)); // Placeholder to
     }
 
     if (consumeOptional(tiny::Token::Step)) {
-        exp = additiveExpression();
-        node.addChildren(tiny::ASTNode(getMetadata(), tiny::ASTNodeType::RangeStepExpression, exp)); // StageStep
+        exp = binaryExpression(ADDITIVE_POWER);
+        node.addChildren(make(tiny::ASTNodeType::RangeStepExpression, exp)); // StageStep
     } else {
-        node.addChildren(tiny::ASTNode(getMetadata(), tiny::ASTNodeType::RangeStepExpression)); // Placeholder step
+        node.addChildren(make(tiny::ASTNodeType::RangeStepExpression)); // Placeholder step
     }
 
     return node;
@@ -330,16 +369,16 @@ tiny::ASTNode tiny::Parser::rangeExpression() {
 /*
  *  ForEachExpression ::= <Identifier> in <AdditiveExpression>
  */
-tiny::ASTNode tiny::Parser::forEachExpression() {
-    tiny::ASTNode node(getMetadata(), tiny::ASTNodeType::ForEachExpression);
+tiny::NodeRef tiny::Parser::forEachExpression() {
+    auto node = make(tiny::ASTNodeType::ForEachExpression);
 
     auto id = consume(tiny::Token::Id);
-    node.addParam(tiny::Parameter(tiny::ParameterType::RangeIdentifier, id.value));
+    node.addParam(tiny::Parameter(tiny::ParameterType::RangeIdentifier, id.getSymbol()));
 
     consume(tiny::Token::KwIn);
 
     // Don't accept anything upstream from additive since it might involve non-numeric operands
-    node.addChildren(additiveExpression()); // From
+    node.addChildren(binaryExpression(ADDITIVE_POWER)); // From
 
     return node;
 }
@@ -347,17 +386,17 @@ tiny::ASTNode tiny::Parser::forEachExpression() {
 /*
  *  FuncDeclStatement ::= func ('(' <TypedExpression> ')') <Identifier> <FunctionArgumentDeclList> <ReturnDeclStatement> \n* <BlockStatement>
  */
-tiny::ASTNode tiny::Parser::funcDeclStatement(bool isPrototype) {
+tiny::NodeRef tiny::Parser::funcDeclStatement(bool isPrototype) {
     consume(tiny::Token::KwFunc);
 
-    tiny::ASTNode node(getMetadata(), tiny::ASTNodeType::FunctionDeclaration);
+    auto node = make(tiny::ASTNodeType::FunctionDeclaration);
 
     // Method?
     if (!isPrototype && consumeOptional(tiny::Token::OParenthesis)) {
-        node.type = tiny::ASTNodeType::MethodDeclaration;
+        node->type = tiny::ASTNodeType::MethodDeclaration;
 
         auto typeExp = typedExpression();
-        typeExp.type = tiny::ASTNodeType::MethodType;
+        typeExp->type = tiny::ASTNodeType::MethodType;
 
         node.addChildren(typeExp);
 
@@ -365,7 +404,7 @@ tiny::ASTNode tiny::Parser::funcDeclStatement(bool isPrototype) {
     }
 
     auto id = consume(tiny::Token::Id);
-    node.addParam(tiny::Parameter(tiny::ParameterType::Name, id.value));
+    node.addParam(tiny::Parameter(tiny::ParameterType::Name, id.getSymbol()));
 
     node.addChildren(argumentDeclList(!isPrototype));
     node.addChildren(returnDeclList());
@@ -374,7 +413,7 @@ tiny::ASTNode tiny::Parser::funcDeclStatement(bool isPrototype) {
 
     if (!isPrototype) {
         auto stmt = blockStatement();
-        node.addChildren(tiny::ASTNode(getMetadata(), ASTNodeType::FunctionBody, stmt));
+        node.addChildren(make(ASTNodeType::FunctionBody, stmt));
     }
 
     return node;
@@ -383,8 +422,8 @@ tiny::ASTNode tiny::Parser::funcDeclStatement(bool isPrototype) {
 /*
  *  FunctionArgumentDeclList ::= ([<AddressableType> (ConstraintList)[, <AddressableType> (ConstraintList)]*|e])
  */
-tiny::ASTNode tiny::Parser::argumentDeclList(bool hasNamedArgs) {
-    tiny::ASTNode node(getMetadata(), tiny::ASTNodeType::FunctionArgumentDeclList);
+tiny::NodeRef tiny::Parser::argumentDeclList(bool hasNamedArgs) {
+    auto node = make(tiny::ASTNodeType::FunctionArgumentDeclList);
 
     consume(tiny::Token::OParenthesis);
 
@@ -392,10 +431,10 @@ tiny::ASTNode tiny::Parser::argumentDeclList(bool hasNamedArgs) {
         // Expect an argument, then if no comma is found break the loop
 
         auto arg = addressableType();
-        arg.type = tiny::ASTNodeType::FunctionArgumentDecl;
+        arg->type = tiny::ASTNodeType::FunctionArgumentDecl;
 
         if (hasNamedArgs) {
-            arg.addParam(tiny::Parameter(tiny::ParameterType::Name, identifier().val));
+            arg.addParam(tiny::Parameter(tiny::ParameterType::Name, identifier()->val));
         }
 
         // Argument constrains
@@ -415,8 +454,8 @@ tiny::ASTNode tiny::Parser::argumentDeclList(bool hasNamedArgs) {
     return node;
 }
 
-tiny::ASTNode tiny::Parser::returnDeclList() {
-    tiny::ASTNode node(getMetadata(), tiny::ASTNodeType::FunctionReturnDeclList);
+tiny::NodeRef tiny::Parser::returnDeclList() {
+    auto node = make(tiny::ASTNodeType::FunctionReturnDeclList);
 
     bool isParenthesised = consumeOptional(tiny::Token::OParenthesis);
 
@@ -424,7 +463,7 @@ tiny::ASTNode tiny::Parser::returnDeclList() {
         // Expect a return type, then if no comma is found break the loop
 
         auto ret = addressableType();
-        ret.type = tiny::ASTNodeType::FunctionArgumentDecl;
+        ret->type = tiny::ASTNodeType::FunctionArgumentDecl;
 
         node.addChildren(ret);
 
@@ -447,11 +486,11 @@ tiny::ASTNode tiny::Parser::returnDeclList() {
 /*
  *  ReturnStatement ::= return ([<Expression>[, <Expression>]*|e])
  */
-tiny::ASTNode tiny::Parser::returnStatement() {
+tiny::NodeRef tiny::Parser::returnStatement() {
     consume(tiny::Token::KwReturn);
 
     auto node = commaSeparatedExpressionList();
-    node.type = tiny::ASTNodeType::FunctionReturn;
+    node->type = tiny::ASTNodeType::FunctionReturn;
 
     return node;
 }
@@ -459,10 +498,10 @@ tiny::ASTNode tiny::Parser::returnStatement() {
 /*
  *  CommaSeparatedExpressionList ::= [<Expression>[, <Expression>]*|e] (TERMINATOR)
  */
-tiny::ASTNode tiny::Parser::commaSeparatedExpressionList(const std::vector<tiny::Token> &terminators) {
-    tiny::ASTNode node(getMetadata(), tiny::ASTNodeType::ExpressionList);
+tiny::NodeRef tiny::Parser::commaSeparatedExpressionList(tiny::TokenSet terminators) {
+    auto node = make(tiny::ASTNodeType::ExpressionList);
 
-    while (std::find(terminators.begin(), terminators.end(), s.peek().token) == terminators.end()) {
+    while (!terminators.contains(s.peek().token)) {
         node.addChildren(expression());
 
         if (!consumeOptional(tiny::Token::Comma)) {
@@ -476,11 +515,11 @@ tiny::ASTNode tiny::Parser::commaSeparatedExpressionList(const std::vector<tiny:
 /*
  *  StructStatement ::= struct <Identifier> (/n*) (<TraitListStatement>) (/n*) <StructFieldList> (/n*)
  */
-tiny::ASTNode tiny::Parser::structStatement() {
+tiny::NodeRef tiny::Parser::structStatement() {
     consume(tiny::Token::KwStruct);
 
-    tiny::ASTNode node(getMetadata(), tiny::ASTNodeType::StructDeclaration);
-    node.addParam(tiny::Parameter(tiny::ParameterType::Name, identifier().val));
+    auto node = make(tiny::ASTNodeType::StructDeclaration);
+    node.addParam(tiny::Parameter(tiny::ParameterType::Name, identifier()->val));
 
     exhaust(tiny::Token::NewLine);
 
@@ -500,11 +539,11 @@ tiny::ASTNode tiny::Parser::structStatement() {
 /*
  *  TraitStatement ::= trait <Identifier> (/n*) (<TraitListStatement>) (/n*) <TraitFieldList> (/n*)
  */
-tiny::ASTNode tiny::Parser::traitStatement() {
+tiny::NodeRef tiny::Parser::traitStatement() {
     consume(tiny::Token::KwTrait);
 
-    tiny::ASTNode node(getMetadata(), tiny::ASTNodeType::TraitDeclaration);
-    node.addParam(tiny::Parameter(tiny::ParameterType::Name, identifier().val));
+    auto node = make(tiny::ASTNodeType::TraitDeclaration);
+    node.addParam(tiny::Parameter(tiny::ParameterType::Name, identifier()->val));
 
     exhaust(tiny::Token::NewLine);
 
@@ -525,16 +564,16 @@ tiny::ASTNode tiny::Parser::traitStatement() {
 /*
  *  TraitListStatement ::= '[' (<Identifier> (/n*) [, <Identifier>]*|e) ']'
  */
-tiny::ASTNode tiny::Parser::traitListStatement() {
+tiny::NodeRef tiny::Parser::traitListStatement() {
     consume(tiny::Token::OBrackets);
 
-    tiny::ASTNode node(getMetadata(), tiny::ASTNodeType::TraitList);
+    auto node = make(tiny::ASTNodeType::TraitList);
 
     while (!check(tiny::Token::CBrackets)) {
         exhaust(tiny::Token::NewLine);
 
         auto trait = identifier();
-        trait.type = tiny::ASTNodeType::Trait;
+        trait->type = tiny::ASTNodeType::Trait;
 
         node.addChildren(trait);
 
@@ -550,8 +589,8 @@ tiny::ASTNode tiny::Parser::traitListStatement() {
 /*
  *  StructFieldList ::= { <Identifier> [,  (/n*) <Identifier>]*|e) }
  */
-tiny::ASTNode tiny::Parser::structFieldList() {
-    tiny::ASTNode node(getMetadata(), tiny::ASTNodeType::StructFieldList);
+tiny::NodeRef tiny::Parser::structFieldList() {
+    auto node = make(tiny::ASTNodeType::StructFieldList);
 
     consume(tiny::Token::OBraces);
     exhaust(tiny::Token::NewLine);
@@ -563,7 +602,7 @@ tiny::ASTNode tiny::Parser::structFieldList() {
             auto id = identifier();
             if (check(tiny::Token::Comma)) {
                 // Lone ID. Composition
-                id.type = tiny::ASTNodeType::Composition;
+                id->type = tiny::ASTNodeType::Composition;
                 node.addChildren(id);
 
                 if (!consumeOptional(tiny::Token::Comma)) {
@@ -581,11 +620,11 @@ tiny::ASTNode tiny::Parser::structFieldList() {
         }
 
         auto field = typedExpression();
-        field.type = tiny::ASTNodeType::StructField;
+        field->type = tiny::ASTNodeType::StructField;
 
-        if (field.hasParam(tiny::ParameterType::Const)) {
+        if (field->hasParam(tiny::ParameterType::Const)) {
             s.backup();
-            throw tiny::ParseError("Constant types are not allowed inside structs", s.get().metadata);
+            throw tiny::ParseError("Constant types are not allowed inside structs", s.get().getMetadata());
         }
 
         node.addChildren(field);
@@ -605,8 +644,8 @@ tiny::ASTNode tiny::Parser::structFieldList() {
 /*
  *  TraitFieldList ::= { <Identifier> [,  (/n*) <Identifier>]*|e) }
  */
-tiny::ASTNode tiny::Parser::traitFieldList() {
-    tiny::ASTNode node(getMetadata(), tiny::ASTNodeType::TraitFieldList);
+tiny::NodeRef tiny::Parser::traitFieldList() {
+    auto node = make(tiny::ASTNodeType::TraitFieldList);
 
     consume(tiny::Token::OBraces);
     exhaust(tiny::Token::NewLine);
@@ -628,9 +667,9 @@ tiny::ASTNode tiny::Parser::traitFieldList() {
         }
 
         auto field = typedExpression();
-        if (field.hasParam(tiny::ParameterType::Const)) {
+        if (field->hasParam(tiny::ParameterType::Const)) {
             s.backup();
-            throw tiny::ParseError("Constant types are not allowed inside traits", s.get().metadata);
+            throw tiny::ParseError("Constant types are not allowed inside traits", s.get().getMetadata());
         }
 
         node.addChildren(field);
@@ -650,8 +689,8 @@ tiny::ASTNode tiny::Parser::traitFieldList() {
 /*
  *  ExpressionStatement ::= <Expression>
  */
-tiny::ASTNode tiny::Parser::expressionStatement(std::vector<tiny::Token> terminators) {
-    tiny::ASTNode exp(getMetadata(), tiny::ASTNodeType::ExpressionStatement);
+tiny::NodeRef tiny::Parser::expressionStatement(tiny::TokenSet terminators) {
+    auto exp = make(tiny::ASTNodeType::ExpressionStatement);
     exp.addChildren(expression());
 
     // We reached the EOF. This means there's a missing newline at the end.
@@ -660,25 +699,19 @@ tiny::ASTNode tiny::Parser::expressionStatement(std::vector<tiny::Token> termina
     }
 
     // Check if the next token is a terminator
-    if (std::find(terminators.begin(), terminators.end(), s.peek().token) == terminators.end()) {
-        throw ParseError("Invalid expression. Multiple statements", s.peek().metadata);
+    if (!terminators.contains(s.peek().token)) {
+        throw ParseError("Invalid expression. Multiple statements", s.peek().getMetadata());
     }
 
     return exp;
 }
 
 /*
- *  Expression ::= <AssignmentExpression>
+ *  Expression ::= <AssignmentExpression> !! <Identifier> <BlockStatement>
+ *              |  <AssignmentExpression> !! <Identifier>
+ *              |  <AssignmentExpression>
  */
-tiny::ASTNode tiny::Parser::expression() {
-    return errorHandleExpression();
-}
-
-/*
- *  ErrorHandleExpression ::= <AssignmentExpression> !! <Identifier> <BlockStatement>
- *                         |  <AssignmentExpression>
- */
-tiny::ASTNode tiny::Parser::errorHandleExpression() {
+tiny::NodeRef tiny::Parser::expression() {
     auto lhs = assignmentExpression();
 
     if (consumeOptional(tiny::Token::Doublebang)) {
@@ -687,18 +720,18 @@ tiny::ASTNode tiny::Parser::errorHandleExpression() {
         if (check(tiny::Token::OBraces)) {
             // Inlined block handle
             auto exp = blockStatement();
-            auto node = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::ErrorHandle, lhs, exp);
+            auto node = make(tiny::ASTNodeType::ErrorHandle, lhs, exp);
 
-            auto varNameParam = tiny::Parameter(tiny::ParameterType::ErrorVarName, id.value);
+            auto varNameParam = tiny::Parameter(tiny::ParameterType::ErrorVarName, id.getSymbol());
             node.addParam(varNameParam);
 
             return node;
         }
 
         // Callback handler
-        auto node = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::ErrorHandle, lhs);
+        auto node = make(tiny::ASTNodeType::ErrorHandle, lhs);
 
-        auto callbackName = tiny::Parameter(tiny::ParameterType::ErrorCallback, id.value);
+        auto callbackName = tiny::Parameter(tiny::ParameterType::ErrorCallback, id.getSymbol());
         node.addParam(callbackName);
 
         return node;
@@ -708,18 +741,18 @@ tiny::ASTNode tiny::Parser::errorHandleExpression() {
 }
 
 /*
- *  AssignmentExpression ::= <LogicalExpression>
- *                        |  <TypedExpression> ':=' <LogicalExpression>
+ *  AssignmentExpression ::= <BinaryExpression>
+ *                        |  <TypedExpression> ':=' <BinaryExpression>
  */
-tiny::ASTNode tiny::Parser::assignmentExpression() {
-    auto lhs = logicalExpression();
+tiny::NodeRef tiny::Parser::assignmentExpression() {
+    auto lhs = binaryExpression();
 
     tiny::ASTNodeType op;
     switch (s.peek().token) {
         case tiny::Token::Init: {
             op = tiny::ASTNodeType::Initialization;
-            if (lhs.type != tiny::ASTNodeType::TypedExpression && lhs.type != tiny::ASTNodeType::Identifier) {
-                throw tiny::ParseError("Can only initialize identifiers", s.get().metadata);
+            if (lhs->type != tiny::ASTNodeType::TypedExpression && lhs->type != tiny::ASTNodeType::Identifier) {
+                throw tiny::ParseError("Can only initialize identifiers", s.get().getMetadata());
             }
 
             break;
@@ -740,10 +773,10 @@ tiny::ASTNode tiny::Parser::assignmentExpression() {
             op = tiny::ASTNodeType::AssignmentDiv;
             break;
         default: {
-            if (lhs.type == tiny::ASTNodeType::TypedExpression) {
+            if (lhs->type == tiny::ASTNodeType::TypedExpression) {
                 // The downstream expression says this is an assignment, but there is no assignment operation so
                 // this mut be a declaration without initialization
-                lhs.type = tiny::ASTNodeType::VarDeclaration;
+                lhs->type = tiny::ASTNodeType::VarDeclaration;
             }
 
             return lhs; // Not an assignment
@@ -753,271 +786,113 @@ tiny::ASTNode tiny::Parser::assignmentExpression() {
 
     s.skip(); // Go over the assignment token
 
-    if (lhs.type != tiny::ASTNodeType::TypedExpression && lhs.type != tiny::ASTNodeType::Identifier
-        && lhs.type != tiny::ASTNodeType::MemberAccess && lhs.type != tiny::ASTNodeType::IndexedAccess) {
-        throw tiny::ParseError("Invalid assignment. Can only assign a value to an identifier", s.get().metadata);
+    if (lhs->type != tiny::ASTNodeType::TypedExpression && lhs->type != tiny::ASTNodeType::Identifier
+        && lhs->type != tiny::ASTNodeType::MemberAccess && lhs->type != tiny::ASTNodeType::IndexedAccess) {
+        throw tiny::ParseError("Invalid assignment. Can only assign a value to an identifier", s.get().getMetadata());
     }
 
-    auto exp = logicalExpression();
-    return tiny::ASTNode(getMetadata(), op, lhs, exp);
+    auto exp = binaryExpression();
+    return make(op, lhs, exp);
 }
 
 /*
- *  LogicalExpression ::= <EqualityExpression>
- *                      |  <EqualityExpression> [[<=|>=|==|!=] <EqualityExpression>]*
+ *  BinaryExpression ::= <UnaryExpression>
+ *                    |  <UnaryExpression> [INFIX_OPERATOR <UnaryExpression>]*
+ *
+ *  Operators are grouped by their binding power in INFIX_TABLE
  */
-tiny::ASTNode tiny::Parser::logicalExpression() {
-    auto lhs = equalityExpression();
+tiny::NodeRef tiny::Parser::binaryExpression(std::uint8_t power) {
+    auto lhs = unaryExpression();
 
     while (true) {
-        tiny::ASTNodeType op;
-
-        switch (s.peek().token) {
-            case tiny::Token::KwAnd: {
-                s.skip();
-                op = tiny::ASTNodeType::LogicalAnd;
-                break;
-            }
-            case tiny::Token::KwOr: {
-                s.skip();
-                op = tiny::ASTNodeType::LogicalOr;
-                break;
-            }
-            default:
-                return lhs;
+        auto const &op = INFIX_LOOKUP[std::size_t(s.peek().token)];
+        if (op.power == 0 || op.power < power) {
+            return lhs;
         }
 
-        auto exp = equalityExpression();
-        lhs = tiny::ASTNode(getMetadata(), op, lhs, exp);
-    }
-}
-
-/*
- *  EqualityExpression ::= <RelationalExpression>
- *                      |  <RelationalExpression> [[and|or] <RelationalExpression>]*
- */
-tiny::ASTNode tiny::Parser::equalityExpression() {
-    auto lhs = relationalExpression();
-
-    while (true) {
-        tiny::ASTNodeType op;
-
-        switch (s.peek().token) {
-            case tiny::Token::Eq: {
-                s.skip();
-                op = tiny::ASTNodeType::CompareEq;
-                break;
-            }
-            case tiny::Token::Neq: {
-                s.skip();
-                op = tiny::ASTNodeType::CompareNeq;
-                break;
-            }
-            case tiny::Token::Gteq: {
-                s.skip();
-                op = tiny::ASTNodeType::CompareGteq;
-                break;
-            }
-            case tiny::Token::Lteq: {
-                s.skip();
-                op = tiny::ASTNodeType::CompareLteq;
-                break;
-            }
-            default:
-                return lhs;
-        }
+        s.skip();
 
-        auto exp = relationalExpression();
-        lhs = tiny::ASTNode(getMetadata(), op, lhs, exp);
+        auto rhs = binaryExpression(op.rightAssociative ? op.power : op.power + 1);
+        lhs = make(op.type, lhs, rhs);
     }
 }
 
 /*
- *  RelationalExpression ::= <AdditiveExpression>
- *                        |  <AdditiveExpression> [[>|<] <AdditiveExpression>]*
+ *  UnaryExpression ::= <PostfixExpression>
+ *                   |  -<UnaryExpression>
+ *                   |  !<UnaryExpression>
+ *                   |  $<PostfixExpression>
+ *                   |  &<PostfixExpression>
  */
-tiny::ASTNode tiny::Parser::relationalExpression() {
-    auto lhs = additiveExpression();
-
-    while (true) {
-        tiny::ASTNodeType op;
-
-        switch (s.peek().token) {
-            case tiny::Token::Gt: {
-                s.skip();
-                op = tiny::ASTNodeType::CompareGt;
-                break;
-            }
-            case tiny::Token::Lt: {
-                s.skip();
-                op = tiny::ASTNodeType::CompareLt;
-                break;
-            }
-            default:
-                return lhs;
+tiny::NodeRef tiny::Parser::unaryExpression() {
+    switch (s.peek().token) {
+        case tiny::Token::Sub: {
+            s.skip();
+            auto exp = unaryExpression();
+            return make(tiny::ASTNodeType::UnaryNegative, exp);
         }
-
-        auto exp = additiveExpression();
-        lhs = tiny::ASTNode(getMetadata(), op, lhs, exp);
-    }
-}
-
-/*
- *  AdditiveExpression ::= <MultiplicativeExpression>
- *                      |  <MultiplicativeExpression> [[+|-] <MultiplicativeExpression>]*
- */
-tiny::ASTNode tiny::Parser::additiveExpression() {
-    auto lhs = multiplicativeExpression();
-
-    while (true) {
-        tiny::ASTNodeType op;
-
-        switch (s.peek().token) {
-            case tiny::Token::Sum: {
-                s.skip();
-                op = tiny::ASTNodeType::OpAddition;
-                break;
-            }
-            case tiny::Token::Sub: {
-                s.skip();
-                op = tiny::ASTNodeType::OpSubtraction;
-                break;
-            }
-            default:
-                return lhs;
+        case tiny::Token::Negation: {
+            s.skip();
+            auto exp = unaryExpression();
+            return make(tiny::ASTNodeType::UnaryNot, exp);
         }
+        case tiny::Token::ValueAt: {
+            s.skip();
+            auto node = postfixExpression();
+            node.addParam(tiny::Parameter(tiny::ParameterType::ValueAt));
 
-        auto exp = additiveExpression();
-        lhs = tiny::ASTNode(getMetadata(), op, lhs, exp);
-    }
-}
-
-/*
- *  MultiplicativeExpression ::= <ExponentiatingExpression>
- *                            |  <ExponentiatingExpression> [[*|'/'] <ExponentiatingExpression>]*
- */
-tiny::ASTNode tiny::Parser::multiplicativeExpression() {
-    auto lhs = exponentiatingExpression();
-
-    while (true) {
-        tiny::ASTNodeType op;
-
-        switch (s.peek().token) {
-            case tiny::Token::Multi: {
-                s.skip();
-                op = tiny::ASTNodeType::OpMultiplication;
-                break;
-            }
-            case tiny::Token::Div: {
-                s.skip();
-                op = tiny::ASTNodeType::OpDivision;
-                break;
-            }
-            default:
-                return lhs;
+            return node;
         }
+        case tiny::Token::Dereference: {
+            s.skip();
+            auto node = postfixExpression();
+            node.addParam(tiny::Parameter(tiny::ParameterType::Dereference));
 
-        auto exp = exponentiatingExpression();
-        lhs = tiny::ASTNode(getMetadata(), op, lhs, exp);
-    }
-}
-
-/*
- *  ExponentiatingExpression ::= <UnaryExpression>
- *                            |  <UnaryExpression> [** <UnaryExpression>]*
- */
-tiny::ASTNode tiny::Parser::exponentiatingExpression() {
-    auto lhs = unaryExpression();
-
-    while (consumeOptional(tiny::Token::Exp)) {
-        auto exp = unaryExpression();
-        lhs = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::OpExponentiate, lhs, exp);
-    }
-
-    return lhs;
-}
-
-/*
- *  UnaryExpression ::= <MemberExpression>
- *                   |  -<MemberExpression>
- *                   |  !<MemberExpression>
- *                   |  $<MemberExpression>
- *                   |  &<MemberExpression>
- */
-tiny::ASTNode tiny::Parser::unaryExpression() {
-    if (consumeOptional(tiny::Token::Sub)) {
-        auto exp = unaryExpression();
-        return tiny::ASTNode(getMetadata(), tiny::ASTNodeType::UnaryNegative, exp);
-    }
-
-    if (consumeOptional(tiny::Token::Negation)) {
-        auto exp = unaryExpression();
-        return tiny::ASTNode(getMetadata(), tiny::ASTNodeType::UnaryNot, exp);
-    }
-
-    if (consumeOptional(tiny::Token::ValueAt)) {
-        auto node = callExpression();
-        node.addParam(tiny::Parameter(tiny::ParameterType::ValueAt));
-
-        return node;
-    }
-
-    if (consumeOptional(tiny::Token::Dereference)) {
-        auto node = callExpression();
-        node.addParam(tiny::Parameter(tiny::ParameterType::Dereference));
-
-        return node;
-    }
-
-    return callExpression();
-}
-
-/*
- *  CallExpression ::= <MemberExpression> (CommaSeparatedExpressionList)
- *                  |  <MemberExpression>
- */
-tiny::ASTNode tiny::Parser::callExpression() {
-    auto lhs = memberExpression();
-
-    while (consumeOptional(tiny::Token::OParenthesis)) {
-        auto args = commaSeparatedExpressionList({tiny::Token::CParenthesis});
-        args.type = ASTNodeType::FunctionCallArgumentList;
-
-        consume(tiny::Token::CParenthesis);
-
-        lhs = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::FunctionCall, lhs, args);
+            return node;
+        }
+        default:
+            return postfixExpression();
     }
-
-    return lhs;
 }
 
 /*
+ *  PostfixExpression ::= <MemberExpression> [(CommaSeparatedExpressionList)]*
+ *
  *  MemberExpression ::= <MemberExpression>.<Identifier>
- *                    |  <MemberExpression>[<Expression>]
+ *                    |  <MemberExpression>[<AssignmentExpression>]
  *                    |  <Primary>
  */
-tiny::ASTNode tiny::Parser::memberExpression() {
+tiny::NodeRef tiny::Parser::postfixExpression() {
     auto lhs = primary();
 
     while (check(tiny::Token::MemberAccess) || check(tiny::Token::OBrackets)) {
         // <MemberExpression>.<Identifier>
         if (consumeOptional(tiny::Token::MemberAccess)) {
             auto id = identifier();
-            lhs = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::MemberAccess, lhs, id);
-            lhs.addParam(tiny::Parameter(tiny::ParameterType::ComputedAccess, false));
+            lhs = make(tiny::ASTNodeType::MemberAccess, lhs, id);
         }
 
-        // <MemberExpression>[<Expression>]
+        // <MemberExpression>[<AssignmentExpression>]
         if (consumeOptional(tiny::Token::OBrackets)) {
             // Don't use expression() since it'll allow for error-handled expressions
             auto exp = assignmentExpression();
-            lhs = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::IndexedAccess, lhs, exp);
-            lhs.addParam(tiny::Parameter(tiny::ParameterType::ComputedAccess, true));
+            lhs = make(tiny::ASTNodeType::IndexedAccess, lhs, exp);
+            lhs.addParam(tiny::Parameter(tiny::ParameterType::ComputedAccess));
 
             consumeOptional(tiny::Token::CBrackets);
         }
     }
 
+    // Calls can only follow the member accesses
+    while (consumeOptional(tiny::Token::OParenthesis)) {
+        auto args = commaSeparatedExpressionList({tiny::Token::CParenthesis});
+        args->type = ASTNodeType::FunctionCallArgumentList;
+
+        consume(tiny::Token::CParenthesis);
+
+        lhs = make(tiny::ASTNodeType::FunctionCall, lhs, args);
+    }
+
     return lhs;
 }
 
@@ -1026,7 +901,7 @@ tiny::ASTNode tiny::Parser::memberExpression() {
  *           |  <Literal>
  *           |  <LHSAssignmentExpression>
  */
-tiny::ASTNode tiny::Parser::primary() {
+tiny::NodeRef tiny::Parser::primary() {
     switch (s.peek().token) {
         case tiny::Token::OParenthesis:
             return parenthExpression();
@@ -1051,12 +926,9 @@ tiny::ASTNode tiny::Parser::primary() {
  *  AssignableLHSExpression ::= <TypedExpression>
  *                           |  <Identifier>
  */
-tiny::ASTNode tiny::Parser::assignableLHSExpression() {
-    auto checkpoint = s.getIndex();
-    try {
+tiny::NodeRef tiny::Parser::assignableLHSExpression() {
+    if (checkTypedExpression(true)) {
         return typedExpression();
-    } catch (tiny::ParseError &) {
-        s.seek(checkpoint);
     }
 
     return identifier();
@@ -1066,27 +938,24 @@ tiny::ASTNode tiny::Parser::assignableLHSExpression() {
  *  TypedExpression ::= <AddressableType> <Identifier>
  *                   |  (const) <AddressableIdentifier> <Identifier>
  */
-tiny::ASTNode tiny::Parser::typedExpression() {
+tiny::NodeRef tiny::Parser::typedExpression() {
     // <AddressableType> <Identifier>
-    auto checkpoint = s.getIndex();
-    try {
-        tiny::ASTNode node(getMetadata(), tiny::ASTNodeType::TypedExpression);
+    if (checkTypedExpression(false)) {
+        auto node = make(tiny::ASTNodeType::TypedExpression);
         node.addChildren(addressableType());
 
-        node.val = consume(tiny::Token::Id).value;
+        node->val = consume(tiny::Token::Id).getSymbol();
 
         return node;
-    } catch (tiny::ParseError &) {
-        s.seek(checkpoint);
     }
 
-    // (const) <AddressableIdentifier> <Identifier>
-    tiny::ASTNode node(getMetadata(), tiny::ASTNodeType::TypedExpression);
+    // (const) <AddressableIdentifier> <Identifier>. Anything that isn't a typed expression fails here
+    auto node = make(tiny::ASTNodeType::TypedExpression);
 
     auto isConst = consumeOptional(tiny::Token::KwConst);
 
     auto id1 = addressableIdentifier();
-    id1.type = tiny::ASTNodeType::Type;
+    id1->type = tiny::ASTNodeType::Type;
 
     if (isConst) {
         id1.addParam(tiny::Parameter(tiny::ParameterType::Const));
@@ -1094,14 +963,15 @@ tiny::ASTNode tiny::Parser::typedExpression() {
 
     node.addChildren(id1);
 
-    node.val = identifier().val;
+    auto id2 = identifier();
+    node->val = id2->val;
     return node;
 }
 
 /*
  *  ParenthExpression ::= '(' <Expression> ')'
  */
-tiny::ASTNode tiny::Parser::parenthExpression() {
+tiny::NodeRef tiny::Parser::parenthExpression() {
     consume(tiny::Token::OParenthesis);
     auto exp = expression();
     consume(tiny::Token::CParenthesis);
@@ -1116,7 +986,7 @@ tiny::ASTNode tiny::Parser::parenthExpression() {
  *           |  <LiteralBool>
  *           |  <LiteralNone>
  */
-tiny::ASTNode tiny::Parser::literal() {
+tiny::NodeRef tiny::Parser::literal() {
     switch (s.peek().token) {
         case tiny::Token::LiteralNum:
             return literalNum();
@@ -1130,27 +1000,30 @@ tiny::ASTNode tiny::Parser::literal() {
         case tiny::Token::LiteralNone:
             return literalNone();
         default:
-            throw ParseError("Invalid literal", s.peek().metadata);
+            throw ParseError("Invalid literal", s.peek().getMetadata());
     }
 }
 
 /*
  *  LiteralNum ::= [0-9]*(.[0-9]*)
  */
-tiny::ASTNode tiny::Parser::literalNum() {
-    // TODO ? Check if the number doesn't fit into a int64 or it's an unsigned number
+tiny::NodeRef tiny::Parser::literalNum() {
+    // The lexer already decoded the literal, so it only needs to be moved into the node
     auto lexeme = consume(tiny::Token::LiteralNum);
 
-    if (lexeme.value.toString().find('.') != std::string::npos) { // Check if it's a decimal number
-        auto node = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::LiteralDecimal);
-        node.val = std::stold(lexeme.value.toString());
+    if (std::holds_alternative<long double>(lexeme.number)) {
+        auto node = make(tiny::ASTNodeType::LiteralDecimal);
+        node->val = arena.addDecimal(std::get<long double>(lexeme.number));
 
         return node;
     }
 
-    // Default to an int64
-    auto node = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::LiteralInt);
-    node.val = std::int64_t(std::stoll(lexeme.value.toString(), nullptr, 0));
+    auto node = make(tiny::ASTNodeType::LiteralInt);
+    if (std::holds_alternative<std::uint64_t>(lexeme.number)) {
+        node->val = std::get<std::uint64_t>(lexeme.number);
+    } else {
+        node->val = std::get<std::int64_t>(lexeme.number);
+    }
 
     return node;
 }
@@ -1158,11 +1031,11 @@ tiny::ASTNode tiny::Parser::literalNum() {
 /*
  *  LiteralStr ::= STRING
  */
-tiny::ASTNode tiny::Parser::literalStr() {
+tiny::NodeRef tiny::Parser::literalStr() {
     auto lexeme = consume(tiny::Token::LiteralStr);
 
-    auto node = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::LiteralString);
-    node.val = tiny::String(lexeme.value);
+    auto node = make(tiny::ASTNodeType::LiteralString);
+    node->val = lexeme.getSymbol();
 
     return node;
 }
@@ -1171,11 +1044,11 @@ tiny::ASTNode tiny::Parser::literalStr() {
 /*
  *  LiteralChar ::= CHAR
  */
-tiny::ASTNode tiny::Parser::literalChar() {
+tiny::NodeRef tiny::Parser::literalChar() {
     auto lexeme = consume(tiny::Token::LiteralChar);
 
-    auto node = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::LiteralChar);
-    node.val = tiny::String(lexeme.value);
+    auto node = make(tiny::ASTNodeType::LiteralChar);
+    node->val = lexeme.getSymbol();
 
     return node;
 }
@@ -1183,34 +1056,34 @@ tiny::ASTNode tiny::Parser::literalChar() {
 /*
  *  LiteralBool ::= True|False
  */
-tiny::ASTNode tiny::Parser::literalBool() {
-    auto node = tiny::ASTNode(getMetadata(), tiny::ASTNodeType::LiteralBool);
+tiny::NodeRef tiny::Parser::literalBool() {
+    auto node = make(tiny::ASTNodeType::LiteralBool);
 
     auto got = s.get();
     switch (got.token) {
         case tiny::Token::LiteralTrue:
-            node.val = true;
+            node->val = true;
             return node;
         case tiny::Token::LiteralFalse:
-            node.val = false;
+            node->val = false;
             return node;
         default:
-            throw tiny::ParseError("Invalid boolean literal", got.metadata);
+            throw tiny::ParseError("Invalid boolean literal", got.getMetadata());
     }
 }
 
 /*
  *  LiteralNone ::= None
  */
-tiny::ASTNode tiny::Parser::literalNone() {
-    auto lexeme = consume(tiny::Token::LiteralNone);
-    return tiny::ASTNode(getMetadata(), tiny::ASTNodeType::LiteralNone);
+tiny::NodeRef tiny::Parser::literalNone() {
+    consume(tiny::Token::LiteralNone);
+    return make(tiny::ASTNodeType::LiteralNone);
 }
 
 /*
  *  AddressableIdentifier ::= [$|&|e]<Identifier>
  */
-tiny::ASTNode tiny::Parser::addressableIdentifier() {
+tiny::NodeRef tiny::Parser::addressableIdentifier() {
     if (consumeOptional(tiny::Token::ValueAt)) {
         auto node = identifier();
         node.addParam(tiny::Parameter(tiny::ParameterType::ValueAt));
@@ -1231,15 +1104,20 @@ tiny::ASTNode tiny::Parser::addressableIdentifier() {
 /*
  *  Identifier ::= STRING
  */
-tiny::ASTNode tiny::Parser::identifier() {
-    return tiny::ASTNode(getMetadata(), tiny::ASTNodeType::Identifier, consume(tiny::Token::Id).value);
+tiny::NodeRef tiny::Parser::identifier() {
+    auto id = consume(tiny::Token::Id);
+
+    auto node = make(tiny::ASTNodeType::Identifier);
+    node->val = id.getSymbol();
+
+    return node;
 }
 
 /*
  *  AddressableType ::= (const) [*|&|e][<Identifier>|BUILTIN_TYPE]
  */
-tiny::ASTNode tiny::Parser::addressableType() {
-    tiny::ASTNode node(getMetadata(), tiny::ASTNodeType::Type);
+tiny::NodeRef tiny::Parser::addressableType() {
+    auto node = make(tiny::ASTNodeType::Type);
 
     if (consumeOptional(tiny::Token::KwConst)) {
         node.addParam(tiny::Parameter(tiny::ParameterType::Const));
@@ -1254,9 +1132,10 @@ tiny::ASTNode tiny::Parser::addressableType() {
     }
 
     if (s.peek().isType()) {
-        node.val = tiny::getTypeName(s.get().token);
+        node->val = tiny::Symbol(tiny::getTypeName(s.get().token));
     } else {
-        node.val = identifier().val;
+        auto id = identifier();
+        node->val = id->val;
     }
 
     return node;
@@ -2,16 +2,32 @@
 #define TINY_PARSER_H
 
 
-#include "stream.h"
+#include <array>
+#include <cstdint>
+
 #include "ast.h"
 #include "lexer.h"
+#include "lexemestream.h"
 
 namespace tiny {
+    //! How an infix operator binds to its operands
+    struct Infix {
+        //! The operator's Token
+        tiny::Token token = tiny::Token::None;
+        //! Type of the node it builds
+        tiny::ASTNodeType type = tiny::ASTNodeType::None;
+        //! How tightly it binds. Zero for Tokens that aren't infix operators
+        std::uint8_t power = 0;
+        //! Whether a chain of operators of the same power nests to the right
+        bool rightAssociative = false;
+    };
+
     /*!
      * \brief Parser takes a stream of Lexemes and sequentially resolves them into an AST via recursive decent
      *
-     * Parser takes a stream of Lexemes (as a Stream) and sequentially resolves them into an Abstract
-     * Syntax Tree using the recursive decent method.
+     * Parser takes a stream of Lexemes (as a LexemeStream) and sequentially resolves them into an Abstract
+     * Syntax Tree using the recursive decent method. Lexemes are pulled from the Lexer as the Parser needs them, so
+     * lexing errors are thrown (as LexError) while parsing, unless the Lexer is in ErrorMode::Recover.
      */
     class Parser {
     public:
@@ -21,10 +37,16 @@ namespace tiny {
         explicit Parser() = default;
 
         /*!
-         * \brief Constructor from a Stream
-         * \param stream Stream of Lexemes that represent a Tiny file
+         * \brief Constructor from a Lexer
+         * \param lexer Lexer over a Tiny file. It must outlive the Parser
          */
-        explicit Parser(tiny::Stream<tiny::Lexeme> &stream) : s(stream) {};
+        explicit Parser(tiny::Lexer &lexer) : s(lexer) {};
+
+        /*!
+         * \brief Constructor from the already lexed tokens of a file
+         * \param tokens Tokens of a Tiny file
+         */
+        explicit Parser(tiny::TokenBuffer tokens) : s(std::move(tokens)) {};
 
         /*!
          * \brief Parses a complete file of source code
@@ -44,7 +66,7 @@ namespace tiny {
          * Lexeme's Token is the matches the given Token's type. If they're mismatched a ParseError exception is thrown.
          * Otherwise the Lexeme is returned.
          */
-        tiny::Lexeme consume(const tiny::Token &token);
+        tiny::TokenRef consume(const tiny::Token &token);
 
         /*!
          * \brief Fetches the next Lexeme in the stream, compares it and advances the stream if they match
@@ -70,7 +92,7 @@ namespace tiny {
          * \brief Exhausts over the set of Token given
          * \param tokens The Tokens to consume
          */
-        void exhaust(const std::vector<tiny::Token> &tokens);
+        void exhaust(tiny::TokenSet tokens);
 
         /*!
          * \brief Gets the next Token (without advancing the steam) and returns whether it matches the provided one
@@ -82,12 +104,30 @@ namespace tiny {
          */
         bool check(tiny::Token token);
 
+        /*!
+         * \brief Looks ahead (without advancing the stream) for the start of a range expression inside a for header
+         * \return True if the next Lexemes are an identifier and an initialization followed by a range operator
+         *
+         * Both a range and an initialization start with "<Identifier> :=", and the range operator can only appear in
+         * a range, so the rest of the header is scanned for it up to the opening brace or the end of the line.
+         */
+        [[nodiscard]] bool checkRangeExpression();
+
+        /*!
+         * \brief Looks ahead (without advancing the stream) for a typed expression
+         * \param allowValueAt Whether a typed expression over a value-at identifier ($x y) is also accepted
+         * \return True if the next Lexemes form a typed expression
+         *
+         * A typed expression is at most four Lexemes long, so it can be predicted without speculatively parsing it.
+         */
+        [[nodiscard]] bool checkTypedExpression(bool allowValueAt);
+
         /*!
          * \brief Expects a module name in the stream, consume the corresponding tokens and returns the module name
          * \param optional Whether an error should be thrown when no module name is present
          * \return The name of the module
          */
-        [[nodiscard]] tiny::String moduleStatement(bool optional = false);
+        [[nodiscard]] tiny::Symbol moduleStatement(bool optional = false);
 
         /*!
          * \brief Consumes an import statement from the stream
@@ -108,168 +148,138 @@ namespace tiny {
          * \brief Consumes a single statement from the stream
          * \return An ASTNode of any of the downstream types
          */
-        [[nodiscard]] tiny::ASTNode statement(std::vector<tiny::Token> terminators = {tiny::Token::NewLine});
+        [[nodiscard]] tiny::NodeRef statement(tiny::TokenSet terminators = {tiny::Token::NewLine});
 
         /*!
          * \brief Consumes a single expression followed by a terminator
-         * \param terminators Optional list of terminators as a vector. Defaults to only NewLine
+         * \param terminators Optional set of terminators. Defaults to only NewLine
          * \return An ASTNode of type ExpressionStatement or any of the downstream types
          */
-        [[nodiscard]] tiny::ASTNode expressionStatement(std::vector<tiny::Token> terminators = {tiny::Token::NewLine});
+        [[nodiscard]] tiny::NodeRef expressionStatement(tiny::TokenSet terminators = {tiny::Token::NewLine});
 
         /*!
          * \brief Consumes a block statement followed by an error handler from the stream
          * \return An ASTNode of type BlockStatement
          */
-        [[nodiscard]] tiny::ASTNode errorHandledBlockStatement();
+        [[nodiscard]] tiny::NodeRef errorHandledBlockStatement();
 
         /*!
          * \brief Consumes a statement encapsulated as a block from the stream
          * \return An ASTNode of type BlockStatement
          */
-        [[nodiscard]] tiny::ASTNode blockStatement();
+        [[nodiscard]] tiny::NodeRef blockStatement();
 
         /*!
          * \brief Consumes an if-branch definition from the stream
          * \return An ASTNode of type IfStatement
          */
-        [[nodiscard]] tiny::ASTNode ifStatement();
+        [[nodiscard]] tiny::NodeRef ifStatement();
 
         /*!
          * \brief Consumes a for-loop definition from the stream
          * \return An ASTNode of type ForStatement
          */
-        [[nodiscard]] tiny::ASTNode forStatement();
+        [[nodiscard]] tiny::NodeRef forStatement();
 
         /*!
          * \brief Consumes an function or method declaration from the stream
          * \param isPrototype Whether the parser should treat the function as a prototype function. Defaults to false
          * \return An ASTNode of type FunctionDeclaration or MethodDeclaration
          */
-        [[nodiscard]] tiny::ASTNode funcDeclStatement(bool isPrototype = false);
+        [[nodiscard]] tiny::NodeRef funcDeclStatement(bool isPrototype = false);
 
         /*!
          * \brief Consumes a list of arguments as given inside a function or method declaration
          * \param isAnonymous Whether the parser should expect no name name for the arguments. Defaults to false
          * \return An ASTNode of type FunctionArgumentDeclList with children of type FunctionArgumentDecl
          */
-        [[nodiscard]] tiny::ASTNode argumentDeclList(bool hasNamedArgs = false);
+        [[nodiscard]] tiny::NodeRef argumentDeclList(bool hasNamedArgs = false);
 
         /*!
          * \brief Consumes list of returns as given inside a function or method declaration
          * \return An ASTNode of type FunctionReturnDeclList with children of type FunctionReturnDec
          */
-        [[nodiscard]] tiny::ASTNode returnDeclList();
+        [[nodiscard]] tiny::NodeRef returnDeclList();
 
         /*!
          * \brief Consumes a return statement (that might contain multiple return-expression) from the stream
          * \return An ASTNode of type FunctionReturn with one children for each return-expression
          */
-        [[nodiscard]] tiny::ASTNode returnStatement();
+        [[nodiscard]] tiny::NodeRef returnStatement();
 
         /*!
          * \brief Consumes a list of comma-separated expressions
-         * \param terminators Optional list of terminators as a vector. Defaults to only NewLine
+         * \param terminators Optional set of terminators. Defaults to only NewLine
          * \return An ASTNode of type ExpressionList with a children for each expression
          */
-        [[nodiscard]] tiny::ASTNode
-        commaSeparatedExpressionList(const std::vector<tiny::Token> &terminators = {tiny::Token::NewLine});
+        [[nodiscard]] tiny::NodeRef
+        commaSeparatedExpressionList(tiny::TokenSet terminators = {tiny::Token::NewLine});
 
         /*!
          * \brief Consumes a struct definition from the stream
          * \return An ASTNode of type StructDeclaration with a StructFieldList and a TraitList children, and a Name parameter
          */
-        [[nodiscard]] tiny::ASTNode structStatement();
+        [[nodiscard]] tiny::NodeRef structStatement();
 
         /*!
          * \brief Consumes a trait definition from the stream
          * \return An ASTNode of type TraitDeclaration with a TraitList and a TraitFieldList children, and a Name parameter
          */
-        [[nodiscard]] tiny::ASTNode traitStatement();
+        [[nodiscard]] tiny::NodeRef traitStatement();
 
         /*!
          * \brief Consumes a list of trait bounds in a struct or a function
          * \return An ASTNode of type TraitList with a child node of type Trait for each trait
          */
-        [[nodiscard]] tiny::ASTNode traitListStatement();
+        [[nodiscard]] tiny::NodeRef traitListStatement();
 
         /*!
          * \brief Consumes a list of struct fields
          * \return An ASTNode of type StructFieldList that might contain either Composition or StructField children
          */
-        [[nodiscard]] tiny::ASTNode structFieldList();
+        [[nodiscard]] tiny::NodeRef structFieldList();
 
         /*!
          * \brief Consumes a list of trait fields
          * \return An ASTNode of type TraitFieldList that might contain either FunctionDeclaration or any of the typed-expression types children
          */
-        [[nodiscard]] tiny::ASTNode traitFieldList();
+        [[nodiscard]] tiny::NodeRef traitFieldList();
 
         /*!
          * \brief Consumes a range expression inside a for-loop definition
          * \return An ASTNode of type RangeExpression with a RangeIdentifier, RangeFromExpression, RangeToExpression and RangeStep child
          */
-        [[nodiscard]] tiny::ASTNode rangeExpression();
+        [[nodiscard]] tiny::NodeRef rangeExpression();
 
         /*!
          * \brief Consumes a for-each iterator expression inside a for-loop definition
          * \return An ASTNode of type ForEachExpression with a RangeIdentifier parameter and an additive expression or downstream node
          */
-        [[nodiscard]] tiny::ASTNode forEachExpression();
+        [[nodiscard]] tiny::NodeRef forEachExpression();
 
         /*!
-         * \brief Base expression handler
-         * \return An ASTNode with any of the expression types
+         * \brief Base expression handler. Consumes an expression that might be followed by an error handler
+         * \return An ASTNode of type ErrorHandle or any of the assignment expression or downstream nodes
          */
-        [[nodiscard]] tiny::ASTNode expression();
-
-        /*!
-         * \brief Consumes the invocation of an error handler for an expression or block
-         * \return An ASTNode of type ErrorHandle and any of the assignment expression or downstream nodes
-         */
-        [[nodiscard]] tiny::ASTNode errorHandleExpression();
+        [[nodiscard]] tiny::NodeRef expression();
 
         /*!
          * \brief Consumes an assignment expression or derivatives to the downstream parsers
          * \return An ASTNode of type Assignment, AssignmentSum, AssignmentSub, AssignmentMulti, AssignmentDiv, Init or any of the downstream nodes
          */
-        [[nodiscard]] tiny::ASTNode assignmentExpression();
-
-        /*!
-         * \brief Consumes an expression built from a logical comparison or derivatives to the downstream parsers
-         * \return An ASTNode of type LogicalAnd or LogicalOr or any of the downstream nodes
-         */
-        [[nodiscard]] tiny::ASTNode logicalExpression();
-
-        /*!
-         * \brief Consumes an expression built from an equality or un-equality check or derivatives to the downstream parsers
-         * \return An ASTNode of type CompareEq, CompareNeq, CompareGteq or CompareLteq or any of the downstream nodes
-         */
-        [[nodiscard]] tiny::ASTNode equalityExpression();
-
-        /*!
-         * \brief Consumes an expression built from a relational comparison between values or derivatives to the downstream parsers
-         * \return An ASTNode of type CompareGt or CompareLt or any of the downstream nodes
-         */
-        [[nodiscard]] tiny::ASTNode relationalExpression();
-
-        /*!
-         * \brief Consumes an expression built from the + or - operators or derivatives to the downstream parsers
-         * \return An ASTNode of type OpAddition or OpSubtraction or any of the downstream nodes
-         */
-        [[nodiscard]] tiny::ASTNode additiveExpression();
+        [[nodiscard]] tiny::NodeRef assignmentExpression();
 
         /*!
-         * \brief Consumes an expression built from the * or / operators or derivatives to the downstream parsers
-         * \return An ASTNode of type OpMultiplication or OpDivision or any of the downstream nodes
-         */
-        [[nodiscard]] tiny::ASTNode multiplicativeExpression();
-
-        /*!
-         * \brief Consumes an expression built from the ** operator or derivatives to the downstream parsers
-         * \return An ASTNode of type OpExponentiate or any of the downstream nodes
+         * \brief Consumes an expression built from infix operators that bind at least as tight as the given power
+         * \param power The lowest binding power accepted. Zero accepts any operator
+         * \return An ASTNode of any of the types in INFIX_TABLE or any of the downstream nodes
+         *
+         * Parses the operands as unary expressions and joins them with a Pratt (precedence-climbing) loop: an operator
+         * is taken while it binds at least as tight as the given power, and its right operand is parsed with its own
+         * power (plus one for left-associative operators), so each nesting of precedence only costs a call once it's
+         * actually used.
          */
-        [[nodiscard]] tiny::ASTNode exponentiatingExpression();
+        [[nodiscard]] tiny::NodeRef binaryExpression(std::uint8_t power = 0);
 
         /*!
          * \brief Consumes an unary expression that actuates over an expression or derivatives to the downstream parsers
@@ -278,25 +288,19 @@ namespace tiny {
          * Consumes an unary expression that actuates over an expression, such as a negation (!x), value-at ($x),
          * dereference (&x) or a negative (-x) or derivatives to the downstream parsers
          */
-        [[nodiscard]] tiny::ASTNode unaryExpression();
-
-        /*!
-         * \brief Consumes an expression that does a call to a method or function or derivatives to the downstream parsers
-         * \return An ASTNode of type FunctionCall with the FunctionCallArgumentList child or any of the downstream nodes
-         */
-        [[nodiscard]] tiny::ASTNode callExpression();
+        [[nodiscard]] tiny::NodeRef unaryExpression();
 
         /*!
-         * \brief Consumes an expression that accesses a member of an struct such as x.y or derivatives to the downstream parsers
-         * \return An ASTNode of type MemberAccess or IndexedAccess with the ComputedAccess parameter set or any of the downstream nodes
+         * \brief Consumes a primary expression followed by any member accesses, and then by any calls
+         * \return An ASTNode of type MemberAccess, IndexedAccess or FunctionCall or any of the downstream nodes
          */
-        [[nodiscard]] tiny::ASTNode memberExpression();
+        [[nodiscard]] tiny::NodeRef postfixExpression();
 
         /*!
          * \brief Consumes a parenthesised expression or derivatives to the downstream parsers
          * \return An ASTNode of the type any of the downstream nodes
          */
-        [[nodiscard]] tiny::ASTNode parenthExpression();
+        [[nodiscard]] tiny::NodeRef parenthExpression();
 
         /*!
          * \brief Consumes an expression that results in an assignable LHS or derivatives to the downstream parsers
@@ -305,55 +309,55 @@ namespace tiny {
          * Consumes an expression that results in an assignable left-hand-side value such as an identifier or a variable
          * declaration or derivatives to the downstream parsers
          */
-        [[nodiscard]] tiny::ASTNode assignableLHSExpression();
+        [[nodiscard]] tiny::NodeRef assignableLHSExpression();
 
         /*!
          * \brief Consumes an expression that utilizes a value whose type is explicitly declared or derivatives to the downstream parsers
          * \return An ASTNode of type TypedExpression or any of the downstream nodes
          */
-        [[nodiscard]] tiny::ASTNode typedExpression();
+        [[nodiscard]] tiny::NodeRef typedExpression();
 
         /*!
          * \brief The primary expression over a single unitary token
          * \return An ASTNode of a parenthesised expression, a LHS assignable expression or a literal
          */
-        [[nodiscard]] tiny::ASTNode primary();
+        [[nodiscard]] tiny::NodeRef primary();
 
         /*!
          * \brief Consumes any type of literal expression
          * \return An ASTNode of a type LiteralInt, LiteralDecimal, LiteralString, LiteralChar, LiteralBool or LiteralNone
          */
-        [[nodiscard]] tiny::ASTNode literal();
+        [[nodiscard]] tiny::NodeRef literal();
 
         /*!
          * \brief Consumes a numeric literal
          * \return An ASTNode of type LiteralInt or LiteralDecimal
          */
-        [[nodiscard]] tiny::ASTNode literalNum();
+        [[nodiscard]] tiny::NodeRef literalNum();
 
         /*!
          * \brief Consumes a string literal
          * \return An ASTNode of type LiteralString
          */
-        [[nodiscard]] tiny::ASTNode literalStr();
+        [[nodiscard]] tiny::NodeRef literalStr();
 
         /*!
          * \brief Consumes a character literal
          * \return An ASTNode of type LiteralChar
          */
-        [[nodiscard]] tiny::ASTNode literalChar();
+        [[nodiscard]] tiny::NodeRef literalChar();
 
         /*!
          * \brief Consumes a boolean literal
          * \return An ASTNode of type LiteralBool
          */
-        [[nodiscard]] tiny::ASTNode literalBool();
+        [[nodiscard]] tiny::NodeRef literalBool();
 
         /*!
          * \brief Consumes a none literal
          * \return An ASTNode of type LiteralNone
          */
-        [[nodiscard]] tiny::ASTNode literalNone();
+        [[nodiscard]] tiny::NodeRef literalNone();
 
         /*!
          * \brief Consumes an identifier that might have an access modifier
@@ -362,13 +366,13 @@ namespace tiny {
          * Consumes an identifier that might (but might not) have an access modifier such as a pointer access or a
          * value-at dereference
          */
-        [[nodiscard]] tiny::ASTNode addressableIdentifier();
+        [[nodiscard]] tiny::NodeRef addressableIdentifier();
 
         /*!
          * \brief Consumes a plain identifier
          * \return An ASTNode of type Identifier
          */
-        [[nodiscard]] tiny::ASTNode identifier();
+        [[nodiscard]] tiny::NodeRef identifier();
 
         /*!
          * \brief Consumes an addressable built-in or custom type
@@ -378,23 +382,80 @@ namespace tiny {
          * access or value-at dereference) and might or might not be defined as constant (preceded by the 'const'
          * keyword)
          */
-        [[nodiscard]] tiny::ASTNode addressableType();
+        [[nodiscard]] tiny::NodeRef addressableType();
+
+        /*!
+         * \brief Adds a node to the arena with the metadata of the latest lexeme
+         * \param t Type of the node
+         * \param children Nodes to link as its children, in order
+         * \return A handle to the new node
+         */
+        template<typename... Children>
+        tiny::NodeRef make(tiny::ASTNodeType t, const Children &...children) {
+            auto node = arena.add(tiny::ASTNode(getMetadata(), t));
+            (node.addChildren(children), ...);
+
+            return node;
+        }
 
         /*!
          * \brief Fetches the metadata of the latest lexeme without modifying the stream's position
          * \return The Metadata object of the latest lexeme in the stream
          */
-        [[nodiscard]] inline tiny::Metadata getMetadata() const {
-            return s.get(s.getIndex() - 1).metadata;
+        [[nodiscard]] inline tiny::Metadata getMetadata() {
+            return s.last().getMetadata();
         }
 
+        /*!
+         * \brief Binding powers of the infix operators
+         *
+         * Operators with a higher power bind tighter. The + and - operators nest to the right, and the rest to the
+         * left.
+         */
+        inline static constexpr tiny::Infix INFIX_TABLE[] = {
+                {tiny::Token::KwAnd, tiny::ASTNodeType::LogicalAnd,       10},
+                {tiny::Token::KwOr,  tiny::ASTNodeType::LogicalOr,        10},
+
+                {tiny::Token::Eq,    tiny::ASTNodeType::CompareEq,        20},
+                {tiny::Token::Neq,   tiny::ASTNodeType::CompareNeq,       20},
+                {tiny::Token::Gteq,  tiny::ASTNodeType::CompareGteq,      20},
+                {tiny::Token::Lteq,  tiny::ASTNodeType::CompareLteq,      20},
+
+                {tiny::Token::Gt,    tiny::ASTNodeType::CompareGt,        30},
+                {tiny::Token::Lt,    tiny::ASTNodeType::CompareLt,        30},
+
+                {tiny::Token::Sum,   tiny::ASTNodeType::OpAddition,       40, true},
+                {tiny::Token::Sub,   tiny::ASTNodeType::OpSubtraction,    40, true},
+
+                {tiny::Token::Multi, tiny::ASTNodeType::OpMultiplication, 50},
+                {tiny::Token::Div,   tiny::ASTNodeType::OpDivision,       50},
+
+                {tiny::Token::Exp,   tiny::ASTNodeType::OpExponentiate,   60},
+        };
+
+        //! Binding power of the + and - operators. Range and for-each expressions don't accept anything looser
+        static constexpr std::uint8_t ADDITIVE_POWER = 40;
+
+        //! INFIX_TABLE indexed by Token, built at compile time
+        inline static constexpr auto INFIX_LOOKUP = [] {
+            std::array<tiny::Infix, std::size_t(tiny::Token::MultilineComment) + 1> lookup{};
+            for (auto const &op: INFIX_TABLE) {
+                lookup[std::size_t(op.token)] = op;
+            }
+
+            return lookup;
+        }();
+
         //! A list of skipable tokens that provide no semantic meaning
-        const std::vector<tiny::Token> SKIPABLE_TOKENS{tiny::Token::SinglelineComment,
-                                                       tiny::Token::MultilineComment,
-                                                       tiny::Token::NewLine};
+        inline static constexpr tiny::TokenSet SKIPABLE_TOKENS{tiny::Token::SinglelineComment,
+                                                               tiny::Token::MultilineComment,
+                                                               tiny::Token::NewLine};
+
+        //! The program stream as a LexemeStream
+        tiny::LexemeStream s;
 
-        //! The program stream as a Stream of Lexemes
-        tiny::Stream<tiny::Lexeme> s;
+        //! Holds the nodes of the file being parsed until they're moved into its ASTFile
+        tiny::ASTArena arena;
 
     };
 }
@@ -89,9 +89,10 @@ std::vector<tiny::Lexeme> tiny::Pipeline::runLexPipe(std::vector<tiny::Lexeme> &
 }
 
 tiny::ASTFile tiny::Pipeline::runParsePipe(tiny::ASTFile &files) const {
+    // ASTFiles own their nodes and can't be copied, so the file is handed from one stage to the next
     for (const auto &s: parseStages) {
-        auto res = s.task(files);
-        files = res.output;
+        auto res = s.task(std::move(files));
+        files = std::move(res.output);
 
         switch (res.action) {
             case tiny::StageAction::Continue:
@@ -105,5 +106,5 @@ tiny::ASTFile tiny::Pipeline::runParsePipe(tiny::ASTFile &files) const {
         }
     }
 
-    return files;
+    return std::move(files);
 }
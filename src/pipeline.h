@@ -4,6 +4,7 @@
 #include <vector>
 #include <fstream>
 #include <functional>
+#include <utility>
 
 #include "lexer.h"
 #include "file.h"
@@ -33,16 +34,16 @@ namespace tiny {
         explicit StageResult(tiny::StageAction a) : action(a) {};
 
         //! Constructs a result with only the output and defaults the action to Continue
-        explicit StageResult(Output o) : output(o) {};
+        explicit StageResult(Output o) : output(std::move(o)) {};
 
         //! Constructs a result without output
         StageResult(tiny::StageAction a, std::string_view msg) : action(a), msg(msg) {};
 
         //! Constructs a result without detail message
-        StageResult(tiny::StageAction a, Output o) : action(a), output(o) {};
+        StageResult(tiny::StageAction a, Output o) : action(a), output(std::move(o)) {};
 
         //! Full constructor for the result
-        StageResult(tiny::StageAction a, Output o, std::string_view msg) : action(a), output(o), msg(msg) {};
+        StageResult(tiny::StageAction a, Output o, std::string_view msg) : action(a), output(std::move(o)), msg(msg) {};
 
         //! The action which the stage decided to take
         tiny::StageAction action = tiny::StageAction::Continue;
@@ -136,7 +137,7 @@ namespace tiny {
 
         /*!
          * \brief Runs back-to-back all the stages inside the parser pipe
-         * \param files The output of the parser
+         * \param files The output of the parser. It's moved into the first stage, or into the result if there are none
          * \return The output of the last stage, or the unmodified input if no stages are set
          */
         tiny::ASTFile runParsePipe(tiny::ASTFile &file) const;
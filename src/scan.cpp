@@ -0,0 +1,163 @@
+#include "scan.h"
+
+#if defined(TINY_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+namespace {
+    /*!
+     * \brief The bytes a scan looks for
+     *
+     * A scan stops at the first byte that is (or, if negated, isn't) any of the three. Sets of less than three bytes
+     * repeat one of them. If pair is set, a match also requires the following byte to be equal to it.
+     */
+    struct ByteSet {
+        char a;
+        char b;
+        char c;
+        bool negate = false;
+        char pair = '\0';
+    };
+
+    //! The ByteSet of each Scan
+    constexpr ByteSet setOf(tiny::Scan scan) {
+        switch (scan) {
+            case tiny::Scan::Newline:
+                return {'\n', '\n', '\n'};
+            case tiny::Scan::StringEnd:
+                return {'"', '\0', '\0'};
+            case tiny::Scan::CommentEnd:
+                return {'*', '*', '*', false, '/'};
+            case tiny::Scan::Blanks:
+            default:
+                return {' ', '\t', '\r', true};
+        }
+    }
+
+    /*!
+     * \brief Checks a single byte against a set
+     * \param bytes The bytes being scanned
+     * \param i Offset of the byte to check
+     * \param set The set to check against
+     * \return True if the scan stops at the byte
+     */
+    inline bool stopsAt(std::string_view bytes, std::size_t i, const ByteSet &set) {
+        char c = bytes[i];
+        bool in = c == set.a || c == set.b || c == set.c;
+        if (set.negate) {
+            return !in;
+        }
+
+        return in && (set.pair == '\0' || (i + 1 < bytes.size() && bytes[i + 1] == set.pair));
+    }
+
+    std::size_t scanScalar(std::string_view bytes, std::size_t from, const ByteSet &set) {
+        std::size_t i = from;
+        for (; i < bytes.size() && !stopsAt(bytes, i, set); i++);
+
+        return i;
+    }
+
+#if defined(TINY_SIMD_X86)
+    __attribute__((target("sse2")))
+    std::size_t scanSSE2(std::string_view bytes, const ByteSet &set) {
+        const auto *data = reinterpret_cast<const unsigned char *>(bytes.data());
+        const __m128i a = _mm_set1_epi8(set.a);
+        const __m128i b = _mm_set1_epi8(set.b);
+        const __m128i c = _mm_set1_epi8(set.c);
+        const __m128i pair = _mm_set1_epi8(set.pair);
+
+        // Pairs need to look one byte past the chunk
+        std::size_t lookahead = set.pair != '\0' ? 1 : 0;
+
+        std::size_t i = 0;
+        for (; i + 16 + lookahead <= bytes.size(); i += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, a), _mm_cmpeq_epi8(chunk, b)),
+                                        _mm_cmpeq_epi8(chunk, c));
+
+            if (lookahead) {
+                __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 1));
+                hits = _mm_and_si128(hits, _mm_cmpeq_epi8(next, pair));
+            }
+
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+            if (set.negate) {
+                mask = ~mask & 0xffffu;
+            }
+
+            if (mask != 0) {
+                return i + static_cast<std::size_t>(__builtin_ctz(mask));
+            }
+        }
+
+        return scanScalar(bytes, i, set);
+    }
+
+    __attribute__((target("avx2")))
+    std::size_t scanAVX2(std::string_view bytes, const ByteSet &set) {
+        const auto *data = reinterpret_cast<const unsigned char *>(bytes.data());
+        const __m256i a = _mm256_set1_epi8(set.a);
+        const __m256i b = _mm256_set1_epi8(set.b);
+        const __m256i c = _mm256_set1_epi8(set.c);
+        const __m256i pair = _mm256_set1_epi8(set.pair);
+
+        // Pairs need to look one byte past the chunk
+        std::size_t lookahead = set.pair != '\0' ? 1 : 0;
+
+        std::size_t i = 0;
+        for (; i + 32 + lookahead <= bytes.size(); i += 32) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, a), _mm256_cmpeq_epi8(chunk, b)),
+                                           _mm256_cmpeq_epi8(chunk, c));
+
+            if (lookahead) {
+                __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 1));
+                hits = _mm256_and_si256(hits, _mm256_cmpeq_epi8(next, pair));
+            }
+
+            auto mask = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+            if (set.negate) {
+                mask = ~mask;
+            }
+
+            if (mask != 0) {
+                return i + static_cast<std::size_t>(__builtin_ctz(mask));
+            }
+        }
+
+        return scanScalar(bytes, i, set);
+    }
+#endif
+}
+
+std::size_t tiny::scan(tiny::Scan scan, std::string_view bytes, tiny::SIMDLevel level) {
+    auto set = setOf(scan);
+
+    switch (level) {
+#if defined(TINY_SIMD_X86)
+        case tiny::SIMDLevel::AVX2:
+            return scanAVX2(bytes, set);
+        case tiny::SIMDLevel::SSE2:
+            return scanSSE2(bytes, set);
+#endif
+        default:
+            return scanScalar(bytes, 0, set);
+    }
+}
+
+std::size_t tiny::findNewline(std::string_view bytes) {
+    return tiny::scan(tiny::Scan::Newline, bytes, tiny::getSIMDLevel());
+}
+
+std::size_t tiny::findStringEnd(std::string_view bytes) {
+    return tiny::scan(tiny::Scan::StringEnd, bytes, tiny::getSIMDLevel());
+}
+
+std::size_t tiny::findCommentEnd(std::string_view bytes) {
+    return tiny::scan(tiny::Scan::CommentEnd, bytes, tiny::getSIMDLevel());
+}
+
+std::size_t tiny::countBlanks(std::string_view bytes) {
+    return tiny::scan(tiny::Scan::Blanks, bytes, tiny::getSIMDLevel());
+}
@@ -0,0 +1,65 @@
+#ifndef TINY_SCAN_H
+#define TINY_SCAN_H
+
+#include <cstddef>
+#include <string_view>
+
+#include "decoder.h"
+
+namespace tiny {
+    /*!
+     * \brief Finds the first newline
+     * \param bytes The bytes to scan
+     * \return The offset of the first '\n', or the size of bytes if there's none
+     *
+     * Like the rest of the scanning functions, it looks at 16 (SSE2) or 32 (AVX2) bytes at a time, using the widest
+     * instruction set the CPU supports. The bytes searched for are all ASCII, so they can't be part of a multi-byte
+     * UTF-8 sequence and the result is the same as decoding the bytes one codepoint at a time.
+     */
+    [[nodiscard]] std::size_t findNewline(std::string_view bytes);
+
+    /*!
+     * \brief Finds the end of the body of a string literal
+     * \param bytes The bytes to scan, starting after the opening quote
+     * \return The offset of the first '"' or NUL byte, or the size of bytes if there's none
+     */
+    [[nodiscard]] std::size_t findStringEnd(std::string_view bytes);
+
+    /*!
+     * \brief Finds the end of a multiline comment
+     * \param bytes The bytes to scan, starting after the opening delimiter
+     * \return The offset of the first closing delimiter (an asterisk followed by a slash), or the size of bytes if
+     * there's none
+     */
+    [[nodiscard]] std::size_t findCommentEnd(std::string_view bytes);
+
+    /*!
+     * \brief Measures the run of blanks at the start of a byte sequence
+     * \param bytes The bytes to scan
+     * \return The number of leading spaces, horizontal tabs and carriage returns
+     */
+    [[nodiscard]] std::size_t countBlanks(std::string_view bytes);
+
+    //! The scans that can be run through scan()
+    enum class Scan {
+        //! findNewline
+        Newline,
+        //! findStringEnd
+        StringEnd,
+        //! findCommentEnd
+        CommentEnd,
+        //! countBlanks
+        Blanks,
+    };
+
+    /*!
+     * \brief Runs any of the scanning functions forcing an instruction set
+     * \param scan The scan to run
+     * \param bytes The bytes to scan
+     * \param level The instruction set to use. Must be supported by the CPU
+     * \return The result of the scanning function
+     */
+    [[nodiscard]] std::size_t scan(tiny::Scan scan, std::string_view bytes, tiny::SIMDLevel level);
+}
+
+#endif //TINY_SCAN_H
@@ -0,0 +1,194 @@
+#include "source.h"
+
+#include <iterator>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+#include "errors.h"
+
+tiny::Source::Source(const std::filesystem::path &path) {
+#if !defined(_WIN32)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw tiny::FileError("Unable to open '" + path.string() + "'");
+    }
+
+    struct stat info{};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw tiny::FileError("Unable to read the size of '" + path.string() + "'");
+    }
+
+    if (info.st_size == 0) {
+        // Empty files can't be mapped, and there's nothing to map anyway
+        ::close(fd);
+        return;
+    }
+
+    void *addr = ::mmap(nullptr, std::size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps its own reference to the file
+
+    if (addr == MAP_FAILED) {
+        throw tiny::FileError("Unable to map '" + path.string() + "'");
+    }
+
+    // The lexer reads the file front to back
+    ::madvise(addr, std::size_t(info.st_size), MADV_SEQUENTIAL);
+
+    mapped = static_cast<const char *>(addr);
+    mappedSize = std::size_t(info.st_size);
+#else
+    // No mapping support on this platform. Read the file in one go instead.
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw tiny::FileError("Unable to open '" + path.string() + "'");
+    }
+
+    owned.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+#endif
+}
+
+tiny::Source::Source(std::istream &stream) {
+    owned.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+tiny::Source::~Source() {
+#if !defined(_WIN32)
+    if (mapped) {
+        ::munmap(const_cast<char *>(mapped), mappedSize);
+    }
+#endif
+}
+
+void tiny::SourceStream::backup() {
+    const char *data = source->data();
+
+    // Make sure that if the index is over the source's length the backup starts at the last codepoint.
+    if (index > source->size()) {
+        index = source->size();
+        backup();
+    }
+
+    if (index == 0) {
+        return;
+    }
+
+    // Step back over the continuation bytes (10xxxxxx) until the start of the previous codepoint
+    do {
+        index--;
+    } while (index > 0 && (static_cast<unsigned char>(data[index]) & 0xc0) == 0x80);
+}
+
+std::string tiny::TextEdit::apply(std::string_view text) const {
+    if (offset + removed > text.size()) {
+        throw std::out_of_range("Edit outside of the text");
+    }
+
+    std::string edited;
+    edited.reserve(text.size() - removed + inserted.size());
+
+    edited.append(text.substr(0, offset));
+    edited.append(inserted);
+    edited.append(text.substr(offset + removed));
+
+    return edited;
+}
+
+std::uint64_t tiny::SourceStream::advance(std::uint64_t i) {
+    for (; i > 0; i--) {
+        if (index >= source->size()) {
+            index += i; // Past the end every codepoint counts as a single position
+            break;
+        }
+
+        auto c = static_cast<unsigned char>(source->data()[index]);
+        if (c < 0x80) {
+            index++;
+        } else {
+            (void) decode(index);
+        }
+    }
+
+    return index;
+}
+
+std::vector<std::uint32_t> tiny::SourceStream::getVector(std::uint64_t from, std::uint64_t to) const {
+    std::vector<std::uint32_t> vec;
+    to = (std::min)(to, std::uint64_t(source->size()));
+
+    while (from < to) {
+        auto c = static_cast<unsigned char>(source->data()[from]);
+        if (c < 0x80) {
+            vec.push_back(c);
+            from++;
+            continue;
+        }
+
+        vec.push_back(decode(from));
+    }
+
+    return vec;
+}
+
+std::uint32_t tiny::SourceStream::decode(std::uint64_t &i) const {
+    const auto *bytes = reinterpret_cast<const unsigned char *>(source->data());
+    std::size_t size = source->size();
+
+    const std::uint32_t replacement = 0xfffd;
+
+    unsigned char lead = bytes[i];
+    std::uint32_t cp;
+    std::size_t length;
+    std::uint32_t min;
+
+    if (lead >= 0xc2 && lead <= 0xdf) {
+        cp = lead & 0x1f;
+        length = 2;
+        min = 0x80;
+    } else if (lead >= 0xe0 && lead <= 0xef) {
+        cp = lead & 0x0f;
+        length = 3;
+        min = 0x800;
+    } else if (lead >= 0xf0 && lead <= 0xf4) {
+        cp = lead & 0x07;
+        length = 4;
+        min = 0x10000;
+    } else {
+        // Stray continuation byte or an invalid lead
+        i++;
+        return replacement;
+    }
+
+    if (i + length > size) {
+        // Truncated sequence at the end of the source
+        i++;
+        return replacement;
+    }
+
+    for (std::size_t n = 1; n < length; n++) {
+        unsigned char byte = bytes[i + n];
+        if ((byte & 0xc0) != 0x80) {
+            i++;
+            return replacement;
+        }
+
+        cp = (cp << 6) | (byte & 0x3f);
+    }
+
+    // Reject overlong encodings, surrogates and values past the last plane
+    if (cp < min || (cp >= 0xd800 && cp <= 0xdfff) || cp > 0x10ffff) {
+        i++;
+        return replacement;
+    }
+
+    i += length;
+    return cp;
+}
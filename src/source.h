@@ -0,0 +1,310 @@
+#ifndef TINY_SOURCE_H
+#define TINY_SOURCE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tiny {
+    /*!
+     * \brief A Source holds the raw UTF-8 bytes of a source file
+     *
+     * A Source holds the raw, undecoded UTF-8 bytes of a source file. Files are memory-mapped when the platform
+     * allows it, so opening a file costs no reads nor copies and pages are only brought in as the lexer reaches them.
+     * Sources built from a std::istream or a std::string own a copy of the bytes instead.
+     */
+    class Source {
+    public:
+        /*!
+         * \brief Creates an empty source
+         */
+        explicit Source() = default;
+
+        /*!
+         * \brief Maps the file at the given path
+         * \param path Path of the file to map
+         *
+         * Maps the file at the given path as read-only. If the file can't be opened or mapped FileError is thrown.
+         */
+        explicit Source(const std::filesystem::path &path);
+
+        /*!
+         * \brief Reads the whole std::istream into the source
+         * \param stream A stream of UTF-8 encoded characters
+         */
+        explicit Source(std::istream &stream);
+
+        /*!
+         * \brief Takes ownership of a string of UTF-8 encoded characters
+         * \param str A UTF-8 encoded std::string
+         */
+        explicit Source(std::string str) : owned(std::move(str)) {};
+
+        //! Unmaps the file, if any
+        ~Source();
+
+        Source(const Source &) = delete;
+        Source &operator=(const Source &) = delete;
+
+        /*!
+         * \brief Gets a pointer to the first byte of the source
+         * \return A pointer to the source's bytes. Not null-terminated
+         */
+        [[nodiscard]] const char *data() const {
+            return mapped ? mapped : owned.data();
+        }
+
+        /*!
+         * \brief Gets the size of the source in bytes
+         * \return The size of the source in bytes
+         */
+        [[nodiscard]] std::size_t size() const {
+            return mapped ? mappedSize : owned.size();
+        }
+
+        /*!
+         * \brief Gets a view over the bytes of the source
+         * \return A std::string_view over the source's bytes
+         */
+        [[nodiscard]] std::string_view view() const {
+            return {data(), size()};
+        }
+
+    private:
+        //! Bytes owned by the source when it isn't backed by a mapping
+        std::string owned;
+
+        //! Start of the mapping, or null if the source isn't mapped
+        const char *mapped = nullptr;
+
+        //! Length of the mapping
+        std::size_t mappedSize = 0;
+    };
+
+    /*!
+     * \brief A TextEdit replaces a range of bytes of a source with new text
+     */
+    struct TextEdit {
+        //! Byte offset where the edit starts
+        std::uint64_t offset = 0;
+
+        //! Number of bytes removed from the offset on
+        std::uint64_t removed = 0;
+
+        //! The UTF-8 text inserted at the offset
+        std::string inserted;
+
+        /*!
+         * \brief Applies the edit to a text
+         * \param text The text before the edit. The removed range must be inside of it
+         * \return The text after the edit
+         */
+        [[nodiscard]] std::string apply(std::string_view text) const;
+
+        /*!
+         * \brief Gets the byte offset where the inserted text ends, once applied
+         * \return The offset of the first byte after the inserted text
+         */
+        [[nodiscard]] std::uint64_t getEnd() const {
+            return offset + inserted.size();
+        }
+
+        /*!
+         * \brief Gets by how much the edit moves the bytes that come after it
+         * \return The difference in bytes between the inserted and the removed text
+         */
+        [[nodiscard]] std::int64_t getShift() const {
+            return std::int64_t(inserted.size()) - std::int64_t(removed);
+        }
+    };
+
+    /*!
+     * \brief A SourceStream is a byte cursor over a Source that yields codepoints
+     *
+     * A SourceStream walks over the UTF-8 bytes of a Source and behaves like a Stream of codepoints. ASCII bytes are
+     * returned as-is and multi-byte sequences are only decoded when they are reached, so the source is never widened
+     * as a whole. Indexes (as returned by getIndex() and taken by seek()) are byte offsets into the source.
+     */
+    class SourceStream {
+    public:
+        /*!
+         * \brief Creates an empty stream
+         */
+        explicit SourceStream() : source(std::make_shared<const tiny::Source>()) {};
+
+        /*!
+         * \brief Creates a stream over a Source
+         * \param src The source to walk over
+         */
+        explicit SourceStream(std::shared_ptr<const tiny::Source> src) : source(std::move(src)) {};
+
+        /*!
+         * \brief Creates a stream by reading a std::istream into a new Source
+         * \param stream A stream of UTF-8 encoded characters
+         */
+        explicit SourceStream(std::istream &stream) : source(std::make_shared<const tiny::Source>(stream)) {};
+
+        /*!
+         * \brief Check whether the end of the stream has been reached
+         * \return True if there's still bytes in the stream, false otherwise
+         */
+        explicit operator bool() const {
+            return index < source->size();
+        }
+
+        /*!
+         * \brief Fetches the next codepoint in the stream and advances past it
+         * \return The next codepoint if the stream is valid, the terminator otherwise
+         */
+        [[nodiscard]] std::uint32_t get() {
+            if (index >= source->size()) {
+                return terminator;
+            }
+
+            auto c = static_cast<unsigned char>(source->data()[index]);
+            if (c < 0x80) {
+                index++;
+                return c;
+            }
+
+            return decode(index);
+        }
+
+        /*!
+         * \brief Fetches the next codepoint in the stream without advancing its position
+         * \return The next codepoint if the stream is valid, the terminator otherwise
+         */
+        [[nodiscard]] std::uint32_t peek() const {
+            return get(index);
+        }
+
+        /*!
+         * \brief Gets the codepoint starting at the given byte offset
+         * \param i The byte offset to decode from
+         * \return The codepoint at i, or the terminator if i is past the end of the source
+         */
+        [[nodiscard]] std::uint32_t get(std::uint64_t i) const {
+            if (i >= source->size()) {
+                return terminator;
+            }
+
+            auto c = static_cast<unsigned char>(source->data()[i]);
+            if (c < 0x80) {
+                return c;
+            }
+
+            return decode(i);
+        }
+
+        //! Goes back one codepoint
+        void backup();
+
+        //! Goes forwards one codepoint
+        void skip() {
+            advance(1);
+        }
+
+        /*!
+         * \brief Goes a number of codepoints forward
+         * \param i The number of codepoints to advance
+         * \return The new byte offset
+         */
+        std::uint64_t advance(std::uint64_t i);
+
+        /*!
+         * \brief Set the stream's byte offset
+         * \param i The new byte offset
+         */
+        void seek(std::uint64_t i) {
+            index = i;
+        }
+
+        /*!
+         * \brief Gets the bytes from the current position to the end of the source
+         * \return A view over the remaining bytes. Empty if the stream is past the end
+         */
+        [[nodiscard]] std::string_view remaining() const {
+            return index < source->size() ? source->view().substr(index) : std::string_view();
+        }
+
+        /*!
+         * \brief Decodes the codepoints that start inside a byte range
+         * \param from The inclusive start of the range
+         * \param to The exclusive end of the range. Clamped to the length of the source
+         * \return The codepoints starting inside [from:to[
+         */
+        [[nodiscard]] std::vector<std::uint32_t> getVector(std::uint64_t from, std::uint64_t to) const;
+
+        /*!
+         * \brief Gets the current byte offset of the stream
+         * \return The stream's byte offset
+         */
+        [[nodiscard]] std::uint64_t getIndex() const {
+            return index;
+        }
+
+        /*!
+         * \brief Gets the terminator value
+         * \return The stream's terminator value
+         */
+        [[nodiscard]] std::uint32_t getTerminator() const {
+            return terminator;
+        }
+
+        /*!
+         * \brief Replaces the terminator value
+         * \param t The new terminator value
+         */
+        void setTerminator(std::uint32_t t) {
+            terminator = t;
+        }
+
+        /*!
+         * \brief Returns whether the provided value is the terminator
+         * \param t A value to compare
+         * \return True if it's the terminator, false otherwise
+         */
+        [[nodiscard]] bool isTerminator(std::uint32_t t) const {
+            return terminator == t;
+        }
+
+        /*!
+         * \brief Returns the length of the stream
+         * \return The length of the underlying source in bytes
+         */
+        [[nodiscard]] std::size_t length() const {
+            return source->size();
+        }
+
+        /*!
+         * \brief Gets the Source the stream walks over
+         * \return The stream's source
+         */
+        [[nodiscard]] const tiny::Source &getSource() const {
+            return *source;
+        }
+
+    private:
+        /*!
+         * \brief Decodes the multi-byte sequence starting at the given offset
+         * \param i The byte offset of the sequence. It's advanced past the sequence
+         * \return The decoded codepoint. Invalid sequences yield U+FFFD and advance a single byte
+         */
+        [[nodiscard]] std::uint32_t decode(std::uint64_t &i) const;
+
+        //! The source being walked over
+        std::shared_ptr<const tiny::Source> source;
+
+        //! Current byte offset of the cursor
+        std::uint64_t index = 0;
+
+        //! Terminator value
+        std::uint32_t terminator = 0;
+    };
+}
+
+#endif //TINY_SOURCE_H
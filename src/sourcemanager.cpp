@@ -0,0 +1,59 @@
+#include "sourcemanager.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+tiny::SourceManager::SourceManager() {
+    // Id 0 is reserved for default-constructed Metadata, which doesn't point to any file
+    add(tiny::File{}, std::make_shared<const tiny::Source>());
+}
+
+tiny::FileId tiny::SourceManager::add(const tiny::File &file, std::shared_ptr<const tiny::Source> source) {
+    std::unique_lock lock(mutex);
+
+    auto &added = entries.emplace_back();
+    added.file = file;
+    added.source = std::move(source);
+
+    return tiny::FileId(entries.size() - 1);
+}
+
+const tiny::SourceManager::Entry &tiny::SourceManager::entry(tiny::FileId id) const {
+    std::shared_lock lock(mutex);
+
+    if (id >= entries.size()) {
+        throw std::out_of_range("No file with id " + std::to_string(id));
+    }
+
+    return entries[id];
+}
+
+std::pair<std::uint64_t, std::uint64_t> tiny::SourceManager::getPosition(tiny::FileId id, std::uint64_t offset) const {
+    const auto &e = entry(id);
+
+    std::call_once(e.linesBuilt, [&e]() {
+        auto bytes = e.source->view();
+
+        e.lineStarts.push_back(0);
+        for (auto i = bytes.find('\n'); i != std::string_view::npos; i = bytes.find('\n', i + 1)) {
+            e.lineStarts.push_back(i + 1);
+        }
+    });
+
+    // Every line starting at or before the offset is a newline before it
+    auto after = std::upper_bound(e.lineStarts.begin(), e.lineStarts.end(), offset);
+    std::uint64_t line = after - e.lineStarts.begin();
+
+    // Columns count codepoints, so walk the (short) distance from the start of the line
+    tiny::SourceStream s(e.source);
+    s.seek(*(after - 1));
+
+    std::uint64_t col = 1;
+    while (s.getIndex() < offset && s) {
+        s.skip();
+        col++;
+    }
+
+    return {line, col};
+}
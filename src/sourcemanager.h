@@ -0,0 +1,119 @@
+#ifndef TINY_SOURCEMANAGER_H
+#define TINY_SOURCEMANAGER_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+#include "file.h"
+#include "source.h"
+
+namespace tiny {
+    //! A FileId identifies a file registered in the SourceManager. Id 0 is reserved for "no file"
+    using FileId = std::uint32_t;
+
+    /*!
+     * \brief The SourceManager owns the source of every file being compiled
+     *
+     * The SourceManager owns the Source of every file being compiled and hands out a compact FileId for each, so
+     * Metadata can point to a file with 32 bits instead of holding a copy of it. It also resolves byte offsets into
+     * lines and columns: the offsets of the start of every line are computed once per file, the first time they're
+     * needed, and each lookup is a binary search over them. It's safe to use from multiple threads.
+     */
+    class SourceManager {
+    public:
+        /*!
+         * \brief Gets the global SourceManager instance
+         * \return A reference to the SourceManager
+         */
+        static SourceManager &get() {
+            static SourceManager instance;
+            return instance;
+        }
+
+        SourceManager(SourceManager const &) = delete;
+        void operator=(SourceManager const &) = delete;
+
+        /*!
+         * \brief Registers a source
+         * \param file The file the source belongs to
+         * \param source The contents of the file
+         * \return The id of the new file
+         */
+        tiny::FileId add(const tiny::File &file, std::shared_ptr<const tiny::Source> source);
+
+        /*!
+         * \brief Maps a file and registers it
+         * \param file The file to map
+         * \return The id of the new file
+         *
+         * Maps a file and registers it. If the file can't be opened or mapped FileError is thrown.
+         */
+        tiny::FileId load(const tiny::File &file) {
+            return add(file, std::make_shared<const tiny::Source>(file.path));
+        }
+
+        /*!
+         * \brief Gets a registered file
+         * \param id The id of the file
+         * \return The file. For id 0 it's an empty File
+         */
+        [[nodiscard]] const tiny::File &getFile(tiny::FileId id) const {
+            return entry(id).file;
+        }
+
+        /*!
+         * \brief Gets the source of a registered file
+         * \param id The id of the file
+         * \return The source of the file. For id 0 it's an empty Source
+         */
+        [[nodiscard]] std::shared_ptr<const tiny::Source> getSource(tiny::FileId id) const {
+            return entry(id).source;
+        }
+
+        /*!
+         * \brief Resolves a byte offset of a file into a line and a column
+         * \param id The id of the file
+         * \param offset Byte offset inside the file
+         * \return A [line, column] pair, both starting at 1. Columns are counted in codepoints
+         */
+        [[nodiscard]] std::pair<std::uint64_t, std::uint64_t> getPosition(tiny::FileId id, std::uint64_t offset) const;
+
+    private:
+        SourceManager();
+
+        //! A registered file
+        struct Entry {
+            //! The file
+            tiny::File file;
+
+            //! The contents of the file
+            std::shared_ptr<const tiny::Source> source;
+
+            //! Guards the lazy construction of lineStarts
+            mutable std::once_flag linesBuilt;
+
+            //! Byte offset of the start of each line
+            mutable std::vector<std::uint64_t> lineStarts;
+        };
+
+        /*!
+         * \brief Gets the entry of a file
+         * \param id The id of the file
+         * \return The entry. Entries are never moved, so the reference stays valid
+         */
+        [[nodiscard]] const Entry &entry(tiny::FileId id) const;
+
+        //! Registered files, indexed by id. A deque so that growing it doesn't move the entries
+        std::deque<Entry> entries;
+
+        //! Guards entries
+        mutable std::shared_mutex mutex;
+    };
+}
+
+#endif //TINY_SOURCEMANAGER_H
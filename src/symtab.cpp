@@ -2,33 +2,11 @@
 #include "logger.h"
 
 void tiny::SymbolTable::build() {
-    for (const auto &node: ast.statements) {
-        update(std::make_shared<ASTNode>(node));
-    }
+    run(ast);
 }
 
-void tiny::SymbolTable::update(const std::shared_ptr<ASTNode> &node, const String &withName) {
-    switch (node->type) {
-    case tiny::ASTNodeType::FunctionDeclaration:
-        parseFunction(node);
-        return;
-
-    case tiny::ASTNodeType::BlockStatement:
-        newInnerScope(withName);
-        break;
-
-    case tiny::ASTNodeType::OpAddition:
-    case tiny::ASTNodeType::OpSubtraction:
-    case tiny::ASTNodeType::OpMultiplication:
-    case tiny::ASTNodeType::OpDivision:
-    case tiny::ASTNodeType::OpExponentiate:
-        parseOperation(node, tiny::Assertion::None);
-        return;
-    }
-
-    for (const auto &c: node->children) {
-        update(c);
-    }
+void tiny::SymbolTable::update(tiny::ConstNodeRef node) {
+    run(node);
 }
 
 tiny::Scope* tiny::SymbolTable::getActive() {
@@ -40,9 +18,67 @@ tiny::Scope* tiny::SymbolTable::getActive() {
     return focus;
 }
 
-tiny::Assertion tiny::SymbolTable::parseOperation(const std::shared_ptr<ASTNode>& node, tiny::Assertion upstream)
+bool tiny::SymbolTable::enter(tiny::NodeTag<tiny::ASTNodeType::FunctionDeclaration>,
+                              tiny::ConstNodeRef node,
+                              tiny::ConstNodeRef) {
+    parseFunction(node);
+    return true;
+}
+
+void tiny::SymbolTable::enter(tiny::NodeTag<tiny::ASTNodeType::FunctionBody>,
+                              tiny::ConstNodeRef,
+                              tiny::ConstNodeRef parent) {
+    // Only the scope of a function's body is named after it
+    if (parent && parent->type == tiny::ASTNodeType::FunctionDeclaration) {
+        bodyNames.push_back(parent->getParam(tiny::ParameterType::Name).getStringVal(parent->meta));
+    } else {
+        bodyNames.emplace_back();
+    }
+}
+
+void tiny::SymbolTable::leave(tiny::NodeTag<tiny::ASTNodeType::FunctionBody>, tiny::ConstNodeRef, tiny::ConstNodeRef) {
+    bodyNames.pop_back();
+}
+
+void tiny::SymbolTable::enter(tiny::NodeTag<tiny::ASTNodeType::BlockStatement>,
+                              tiny::ConstNodeRef,
+                              tiny::ConstNodeRef parent) {
+    if (parent && parent->type == tiny::ASTNodeType::FunctionBody) {
+        newInnerScope(bodyNames.back());
+    } else {
+        newInnerScope();
+    }
+}
+
+void tiny::SymbolTable::enter(tiny::NodeTag<tiny::ASTNodeType::LiteralInt>,
+                              tiny::ConstNodeRef,
+                              tiny::ConstNodeRef parent) {
+    setOperandType(tiny::Assertion::IsNumeric, parent);
+}
+
+void tiny::SymbolTable::enter(tiny::NodeTag<tiny::ASTNodeType::LiteralChar>,
+                              tiny::ConstNodeRef,
+                              tiny::ConstNodeRef parent) {
+    setOperandType(tiny::Assertion::IsText, parent);
+}
+
+void tiny::SymbolTable::enter(tiny::NodeTag<tiny::ASTNodeType::LiteralString>,
+                              tiny::ConstNodeRef,
+                              tiny::ConstNodeRef parent) {
+    setOperandType(tiny::Assertion::IsText, parent);
+}
+
+void tiny::SymbolTable::setOperandType(tiny::Assertion t, tiny::ConstNodeRef parent)
 {
-    tiny::TypeInfo typeInfo(upstream);
+    if (parent && parent->isOperation()) {
+        operations.back().setType(t, parent->meta);
+    }
+}
+
+void tiny::SymbolTable::enterOperation(tiny::ConstNodeRef node, tiny::ConstNodeRef parent)
+{
+    // Nested operations start from the type inferred so far by their parent
+    tiny::TypeInfo typeInfo(parent && parent->isOperation() ? operations.back().getType() : tiny::Assertion::None);
 
     // These operations only work for numerics
     if (node->type == tiny::ASTNodeType::OpDivision
@@ -51,25 +87,15 @@ tiny::Assertion tiny::SymbolTable::parseOperation(const std::shared_ptr<ASTNode>
         typeInfo.setType(tiny::Assertion::IsNumeric, node->meta);
     }
 
-    for (const auto &c: node->children) {
-        if (c->type == tiny::ASTNodeType::LiteralInt) {
-            typeInfo.setType(tiny::Assertion::IsNumeric, node->meta);
-            continue;
-        }
-
-        if (c->type == tiny::ASTNodeType::LiteralChar || c->type == tiny::ASTNodeType::LiteralString) {
-            typeInfo.setType(tiny::Assertion::IsText, node->meta);
-            continue;
-        }
+    operations.push_back(typeInfo);
+}
 
-        if (c->isOperation()) {
-            typeInfo.setType(parseOperation(c, typeInfo.getType()), c->meta);
-        } else {
-            update(c);
-        }
-    }
+void tiny::SymbolTable::leaveOperation(tiny::ConstNodeRef node, tiny::ConstNodeRef parent)
+{
+    auto typeInfo = operations.back();
+    operations.pop_back();
 
-    for (const auto &c: node->children) {
+    for (auto c: node.children()) {
         if (c->type==tiny::ASTNodeType::Identifier) {
             getActive()->addPromise(tiny::Promise(
                     c->getStringVal(),
@@ -86,24 +112,24 @@ tiny::Assertion tiny::SymbolTable::parseOperation(const std::shared_ptr<ASTNode>
 
         if (c->type==tiny::ASTNodeType::FunctionCall) {
             getActive()->addPromise(tiny::Promise(
-                    c->getFirstChild()->getStringVal(),
+                    c.getFirstChild()->getStringVal(),
                     tiny::Assertion::IsDefined,
                     c->meta));
 
             getActive()->addPromise(tiny::Promise(
-                    c->getFirstChild()->getStringVal(),
+                    c.getFirstChild()->getStringVal(),
                     tiny::Assertion::IsCallable,
                     c->meta));
 
             getActive()->addPromise(tiny::Promise(
-                    c->getFirstChild()->getStringVal(),
+                    c.getFirstChild()->getStringVal(),
                     tiny::Assertion::CallReturnCount,
                     "1",
                     c->meta));
 
             if (typeInfo.isSet()) {
                 getActive()->addPromise(tiny::Promise(
-                        c->getFirstChild()->getStringVal(),
+                        c.getFirstChild()->getStringVal(),
                         tiny::Assertion::CallReturns,
                         typeInfo.getTypeName(c->meta),
                         0,
@@ -112,10 +138,13 @@ tiny::Assertion tiny::SymbolTable::parseOperation(const std::shared_ptr<ASTNode>
         }
     }
 
-    return typeInfo.getType();
+    // The type of a nested operation narrows the one of its parent
+    if (parent && parent->isOperation()) {
+        operations.back().setType(typeInfo.getType(), node->meta);
+    }
 }
 
-void tiny::SymbolTable::parseFunction(const std::shared_ptr<ASTNode> &node)
+void tiny::SymbolTable::parseFunction(tiny::ConstNodeRef node)
 {
     auto active = getActive();
     auto funcName = node->getParam(tiny::ParameterType::Name).getStringVal(node->meta);
@@ -134,7 +163,7 @@ void tiny::SymbolTable::parseFunction(const std::shared_ptr<ASTNode> &node)
     auto funcScope = getActive();
 
     int i = 0;
-    for (const auto &arg: node->getChild(tiny::ASTNodeType::FunctionArgumentDeclList)->children) {
+    for (auto arg: node.getChild(tiny::ASTNodeType::FunctionArgumentDeclList).children()) {
         auto argName = arg->getParam(tiny::ParameterType::Name).getStringVal(node->meta);
         auto argType = arg->getStringVal();
 
@@ -160,7 +189,7 @@ void tiny::SymbolTable::parseFunction(const std::shared_ptr<ASTNode> &node)
     }
 
     i = 0;
-    for (const auto &arg: node->getChild(tiny::ASTNodeType::FunctionReturnDeclList)->children) {
+    for (auto arg: node.getChild(tiny::ASTNodeType::FunctionReturnDeclList).children()) {
         auto argName = arg->getParam(tiny::ParameterType::Name).getStringVal(node->meta);
         auto argType = arg->getStringVal();
 
@@ -189,30 +218,25 @@ void tiny::SymbolTable::parseFunction(const std::shared_ptr<ASTNode> &node)
     active->addFulfilment(tiny::Promise(
             funcName,
             tiny::Assertion::CallReturnCount,
-            tiny::String(std::to_string(i)),
+            tiny::Symbol(std::to_string(i)),
             node->meta));
-
-
-    for (const auto &c: node->getChild(tiny::ASTNodeType::FunctionBody)->children) {
-        update(c, funcName);
-    }
 }
 
-void tiny::SymbolTable::newInnerScope(const tiny::String &name)
+void tiny::SymbolTable::newInnerScope(const tiny::Symbol &name)
 {
     getActive()->inner.emplace_back(tiny::Scope{tiny::ScopeType::NonGlobal, name});
 }
 
 void tiny::Scope::addPromise(tiny::Promise promise) {
-    tiny::debug(promise.meta.file,
-            "<- (" + (!name.codepoints.empty() ? name.toString() : "?") + ") " + promise.toString().toString());
+    tiny::debug(promise.meta.getFile(),
+            "<- (" + (!name.empty() ? name.toString() : "?") + ") " + promise.toString().toString());
 
     promises.push_back(std::move(promise));
 }
 
 void tiny::Scope::addFulfilment(tiny::Promise fulfilment) {
-    tiny::debug(fulfilment.meta.file,
-            "-> (" + (!name.codepoints.empty() ? name.toString() : "?") + ") " + fulfilment.toString().toString());
+    tiny::debug(fulfilment.meta.getFile(),
+            "-> (" + (!name.empty() ? name.toString() : "?") + ") " + fulfilment.toString().toString());
 
     fulfillments.push_back(std::move(fulfilment));
 }
@@ -223,27 +247,27 @@ tiny::String tiny::Promise::toString() const
     case Assertion::None:
         return "Void assertion";
     case Assertion::IsDefined:
-        return identifier + " is defined";
+        return identifier.str() + " is defined";
     case Assertion::HasMember:
-        return identifier + " has member " + argument;
+        return identifier.str() + " has member " + argument.str();
     case Assertion::IsIndexable:
-        return identifier + " is indexable";
+        return identifier.str() + " is indexable";
     case Assertion::IsStruct:
-        return identifier + " is a struct";
+        return identifier.str() + " is a struct";
     case Assertion::IsCallable:
-        return identifier + " is callable";
+        return identifier.str() + " is callable";
     case Assertion::CallRequires:
-        return identifier + " requires argument " + argument + " in position " + std::to_string(position);
+        return identifier.str() + " requires argument " + argument.str() + " in position " + std::to_string(position);
     case Assertion::CallReturns:
-        return identifier + " returns " + argument + " in position " + std::to_string(position);
+        return identifier.str() + " returns " + argument.str() + " in position " + std::to_string(position);
     case Assertion::CallReturnCount:
-        return identifier + " returns " + argument + " value(s)";
+        return identifier.str() + " returns " + argument.str() + " value(s)";
     case Assertion::IsNumeric:
-        return identifier + " is of a numeric type";
+        return identifier.str() + " is of a numeric type";
     case Assertion::IsText:
-        return identifier + " is type-compatible with " + argument;
+        return identifier.str() + " is type-compatible with " + argument.str();
     case Assertion::IsOfType:
-        return identifier + " is of type " + argument;
+        return identifier.str() + " is of type " + argument.str();
     default:
         return "Invalid promise";
     }
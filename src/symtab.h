@@ -2,11 +2,13 @@
 #define TINY_SYMTAB_H
 
 #include <utility>
+#include <vector>
 
 #include "unicode.h"
 #include "metadata.h"
 #include "ast.h"
 #include "errors.h"
+#include "visitor.h"
 
 namespace tiny {
     enum class Assertion {
@@ -26,18 +28,18 @@ namespace tiny {
 
     struct Promise {
     public:
-        Promise(tiny::String identifier, tiny::Assertion assertion, tiny::Metadata meta):
-        identifier(std::move(identifier)), assertion(assertion), meta(std::move(meta)) {};
+        Promise(tiny::Symbol identifier, tiny::Assertion assertion, tiny::Metadata meta):
+        identifier(identifier), assertion(assertion), meta(std::move(meta)) {};
 
-        Promise(tiny::String identifier, tiny::Assertion assertion, tiny::String arg, tiny::Metadata meta):
-                identifier(std::move(identifier)), assertion(assertion), argument(std::move(arg)), meta(std::move(meta)) {};
+        Promise(tiny::Symbol identifier, tiny::Assertion assertion, tiny::Symbol arg, tiny::Metadata meta):
+                identifier(identifier), assertion(assertion), argument(arg), meta(std::move(meta)) {};
 
-        Promise(tiny::String identifier, tiny::Assertion assertion, tiny::String arg, std::uint32_t pos, tiny::Metadata meta):
-                identifier(std::move(identifier)), assertion(assertion), argument(std::move(arg)), position(pos), meta(std::move(meta)) {};
+        Promise(tiny::Symbol identifier, tiny::Assertion assertion, tiny::Symbol arg, std::uint32_t pos, tiny::Metadata meta):
+                identifier(identifier), assertion(assertion), argument(arg), position(pos), meta(std::move(meta)) {};
 
-        tiny::String identifier;
+        tiny::Symbol identifier;
         tiny::Assertion assertion;
-        tiny::String argument;
+        tiny::Symbol argument;
         std::uint32_t position;
 
         tiny::Metadata meta;
@@ -53,7 +55,7 @@ namespace tiny {
     struct Scope {
     public:
         tiny::ScopeType type = tiny::ScopeType::Global;
-        tiny::String name;
+        tiny::Symbol name;
 
         std::vector<tiny::Promise> promises = {};
         std::vector<tiny::Promise> fulfillments = {};
@@ -64,27 +66,6 @@ namespace tiny {
         void addFulfilment(tiny::Promise fulfilment);
     };
 
-    struct SymbolTable {
-    public:
-        explicit SymbolTable(const tiny::ASTFile &ast): ast(ast) {};
-
-        const tiny::ASTFile &ast;
-        tiny::Scope root = {tiny::ScopeType::Global, "global"};
-
-        void build();
-        void update(const std::shared_ptr<ASTNode> &node, const String &withName= "");
-
-        void validate();
-
-        [[nodiscard]] tiny::Scope* getActive();
-
-    private:
-        void newInnerScope(const tiny::String &name = "");
-
-        tiny::Assertion parseOperation(const std::shared_ptr<ASTNode>& node, tiny::Assertion upstream);
-        void parseFunction(const std::shared_ptr<ASTNode>& shared_ptr);
-    };
-
     class TypeInfo {
     public:
         TypeInfo() = default;
@@ -126,13 +107,70 @@ namespace tiny {
             type = t;
         }
 
-        bool isSet() {
+        [[nodiscard]] bool isSet() const {
             return type != tiny::Assertion::None;
         }
 
     private:
         tiny::Assertion type = tiny::Assertion::None;
     };
+
+    struct SymbolTable : tiny::Pass<tiny::SymbolTable> {
+    public:
+        explicit SymbolTable(const tiny::ASTFile &ast): ast(ast) {};
+
+        const tiny::ASTFile &ast;
+        tiny::Scope root = {tiny::ScopeType::Global, "global"};
+
+        void build();
+        void update(tiny::ConstNodeRef node);
+
+        void validate();
+
+        [[nodiscard]] tiny::Scope* getActive();
+
+        // Hooks run by tiny::visit. The table can be fused with other passes through them
+        bool enter(tiny::NodeTag<tiny::ASTNodeType::FunctionDeclaration>, tiny::ConstNodeRef node,
+                   tiny::ConstNodeRef parent);
+        void enter(tiny::NodeTag<tiny::ASTNodeType::FunctionBody>, tiny::ConstNodeRef node, tiny::ConstNodeRef parent);
+        void leave(tiny::NodeTag<tiny::ASTNodeType::FunctionBody>, tiny::ConstNodeRef node, tiny::ConstNodeRef parent);
+        void enter(tiny::NodeTag<tiny::ASTNodeType::BlockStatement>, tiny::ConstNodeRef node,
+                   tiny::ConstNodeRef parent);
+        void enter(tiny::NodeTag<tiny::ASTNodeType::LiteralInt>, tiny::ConstNodeRef node, tiny::ConstNodeRef parent);
+        void enter(tiny::NodeTag<tiny::ASTNodeType::LiteralChar>, tiny::ConstNodeRef node, tiny::ConstNodeRef parent);
+        void enter(tiny::NodeTag<tiny::ASTNodeType::LiteralString>, tiny::ConstNodeRef node, tiny::ConstNodeRef parent);
+
+        //! Hook for operations, and for the children of function declarations, which are skipped except for the body
+        template<tiny::ASTNodeType T>
+        bool enter(tiny::NodeTag<T>, tiny::ConstNodeRef node, tiny::ConstNodeRef parent) {
+            if constexpr (T >= tiny::ASTNodeType::OpAddition && T <= tiny::ASTNodeType::OpExponentiate) {
+                enterOperation(node, parent);
+                return true;
+            } else {
+                return !parent || parent->type != tiny::ASTNodeType::FunctionDeclaration;
+            }
+        }
+
+        template<tiny::ASTNodeType T>
+        void leave(tiny::NodeTag<T>, tiny::ConstNodeRef node, tiny::ConstNodeRef parent) {
+            if constexpr (T >= tiny::ASTNodeType::OpAddition && T <= tiny::ASTNodeType::OpExponentiate) {
+                leaveOperation(node, parent);
+            }
+        }
+
+    private:
+        //! Types inferred so far for the operands of the operations being visited, innermost last
+        std::vector<tiny::TypeInfo> operations;
+        //! Names given to the scopes of the function bodies being visited, innermost last
+        std::vector<tiny::Symbol> bodyNames;
+
+        void newInnerScope(const tiny::Symbol &name = tiny::Symbol());
+
+        void enterOperation(tiny::ConstNodeRef node, tiny::ConstNodeRef parent);
+        void leaveOperation(tiny::ConstNodeRef node, tiny::ConstNodeRef parent);
+        void setOperandType(tiny::Assertion t, tiny::ConstNodeRef parent);
+        void parseFunction(tiny::ConstNodeRef node);
+    };
 }
 
 #endif //TINY_SYMTAB_H
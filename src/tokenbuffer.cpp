@@ -0,0 +1,104 @@
+#include "tokenbuffer.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+tiny::Metadata tiny::TokenRef::getMetadata() const {
+    if (buffer == nullptr) {
+        return tiny::Metadata();
+    }
+
+    return tiny::Metadata(buffer->getFile(), start, end);
+}
+
+void tiny::TokenBuffer::push(const tiny::Lexeme &l) {
+    resize(size() + 1);
+    set(size() - 1, l);
+}
+
+void tiny::TokenBuffer::push(const tiny::TokenRef &t) {
+    resize(size() + 1);
+    set(size() - 1, t);
+}
+
+void tiny::TokenBuffer::append(const tiny::TokenBuffer &other, std::size_t from, std::size_t to,
+                               std::int64_t shift) {
+    to = (std::min)(to, other.size());
+    if (from >= to) {
+        return;
+    }
+
+    auto at = size();
+    resize(at + to - from);
+
+    for (auto i = from; i < to; i++, at++) {
+        tokens[at] = other.tokens[i];
+        starts[at] = std::uint32_t(other.starts[i] + shift);
+        ends[at] = std::uint32_t(other.ends[i] + shift);
+        valueStarts[at] = other.valueLengths[i] == 0 ? 0 : std::uint32_t(other.valueStarts[i] + shift);
+        valueLengths[at] = other.valueLengths[i];
+
+        // Tokens are appended after every existing one, so the entry goes last
+        if (other.tokens[i] == tiny::Token::LiteralNum) {
+            numbers.emplace_back(std::uint32_t(at), other.getNumber(i));
+        }
+
+        if (valueStarts[at] + std::uint64_t(valueLengths[at]) > source.size()) {
+            throw std::invalid_argument("Token value outside of the TokenBuffer's source");
+        }
+    }
+}
+
+void tiny::TokenBuffer::set(std::size_t i, const tiny::Lexeme &l) {
+    store(i, l.token, l.value, l.number, l.metadata.start, l.metadata.end);
+}
+
+void tiny::TokenBuffer::set(std::size_t i, const tiny::TokenRef &t) {
+    store(i, t.token, t.value, t.number, t.start, t.end);
+}
+
+void tiny::TokenBuffer::resize(std::size_t n) {
+    tokens.resize(n, tiny::Token::None);
+    starts.resize(n);
+    ends.resize(n);
+    valueStarts.resize(n);
+    valueLengths.resize(n);
+    numbers.resize(findNumber(n));
+}
+
+void tiny::TokenBuffer::store(std::size_t i, tiny::Token token, std::string_view value,
+                              const tiny::Number &number, std::uint64_t start, std::uint64_t end) {
+    constexpr auto max = std::numeric_limits<std::uint32_t>::max();
+    if (start > max || end > max) {
+        throw std::length_error("Source too big for a TokenBuffer");
+    }
+
+    std::uint32_t valueStart = 0;
+    if (!value.empty()) {
+        if (value.data() < source.data() || value.data() + value.size() > source.data() + source.size()) {
+            throw std::invalid_argument("Token value outside of the TokenBuffer's source");
+        }
+
+        valueStart = std::uint32_t(value.data() - source.data());
+    }
+
+    tokens[i] = token;
+    starts[i] = std::uint32_t(start);
+    ends[i] = std::uint32_t(end);
+    valueStarts[i] = valueStart;
+    valueLengths[i] = std::uint32_t(value.size());
+
+    // Only numeric literals keep an entry, so the rest of the tokens don't pay for a decoded value
+    auto at = findNumber(i);
+    bool found = at < numbers.size() && numbers[at].first == i;
+    if (token == tiny::Token::LiteralNum) {
+        if (found) {
+            numbers[at].second = number;
+        } else {
+            numbers.emplace(numbers.begin() + std::ptrdiff_t(at), std::uint32_t(i), number);
+        }
+    } else if (found) {
+        numbers.erase(numbers.begin() + std::ptrdiff_t(at));
+    }
+}
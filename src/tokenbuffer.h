@@ -0,0 +1,300 @@
+#ifndef TINY_TOKENBUFFER_H
+#define TINY_TOKENBUFFER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "lexer.h"
+
+namespace tiny {
+    class TokenBuffer;
+
+    /*!
+     * \brief A TokenRef is a lightweight handle to a token stored in a TokenBuffer
+     *
+     * A TokenRef holds the token, the view of its value and its offsets, plus a pointer to the TokenBuffer it came from
+     * for everything that is shared by all of the buffer's tokens (like the file). Unlike a Lexeme it holds no
+     * Metadata, so copying it is cheaper; the Metadata is built on demand. Values are views into the source, which
+     * must outlive the TokenRef, and the TokenBuffer must outlive it if getMetadata is used.
+     */
+    struct TokenRef {
+        //! The Token of the token
+        tiny::Token token = tiny::Token::None;
+
+        //! The optional associated data of the token. A view into the source buffer that produced it.
+        std::string_view value;
+
+        //! The decoded value of numeric literals. Zero for any other token
+        tiny::Number number;
+
+        //! Byte offset of the token start
+        std::uint32_t start = 0;
+
+        //! Byte offset of the token end
+        std::uint32_t end = 0;
+
+        //! Buffer holding the token. Null for a default-constructed TokenRef
+        const tiny::TokenBuffer *buffer = nullptr;
+
+        /*!
+         * \brief Builds the Metadata of the token
+         * \return The Metadata with the buffer's file and the token's offsets
+         */
+        [[nodiscard]] tiny::Metadata getMetadata() const;
+
+        /*!
+         * \brief Copies the token into a standalone Lexeme
+         * \return A Lexeme with the same token, value and Metadata
+         */
+        [[nodiscard]] tiny::Lexeme getLexeme() const {
+            return tiny::Lexeme(token, value, number, getMetadata());
+        }
+
+        /*!
+         * \brief Gets a string representation of the token
+         * \return A string with a description of the token, as given by Lexeme::string
+         */
+        [[nodiscard]] std::string string() const {
+            return tiny::Lexeme(token, value, tiny::Metadata()).string();
+        }
+
+        /*!
+         * \brief Interns the value of the token
+         * \return A Symbol holding the value, that stays valid after the source is gone
+         */
+        [[nodiscard]] tiny::Symbol getSymbol() const {
+            return tiny::Symbol(value);
+        }
+
+        /*!
+         * \brief Compares the token's Token with the one provided
+         * \return Whether the token's and the provided Token are equal
+         */
+        bool operator==(const Token &rhs) const {
+            return token == rhs;
+        }
+
+        /*!
+         * \brief Asserts the inequality of the token's Token with the provided Token
+         * \return Whether the token's Token and the provided one are unequal
+         */
+        bool operator!=(const Token &rhs) const {
+            return token != rhs;
+        }
+
+        /*!
+         * \brief Asserts the equality of two tokens
+         * \return Whether both the Token and the value are the same
+         */
+        bool operator==(const TokenRef &rhs) const {
+            return token == rhs.token && value == rhs.value;
+        }
+
+        /*!
+         * \brief Asserts the inequality of two tokens
+         * \return The negation of the == operator
+         */
+        bool operator!=(const TokenRef &rhs) const {
+            return !(*this == rhs);
+        }
+
+        /*!
+         * \brief Checks whether the token corresponds to a built-in type Token
+         * \return True if the token is a built-in type token
+         */
+        [[nodiscard]] bool isType() const {
+            return tiny::Lexeme(token).isType();
+        }
+    };
+
+    /*!
+     * \brief A TokenBuffer stores the tokens of a file as a struct of arrays
+     *
+     * A TokenBuffer stores each field of its tokens in its own contiguous array: the Tokens, the start and end offsets,
+     * the offset and length of the values inside the source and the decoded value of numeric literals. The file is
+     * stored once for the whole buffer instead of in every token. Tokens are read back as TokenRef handles.
+     *
+     * Only tokens produced by a Lexer over the buffer's source can be stored, since values are kept as offsets into
+     * it. Offsets are 32-bit, so sources are limited to 4GiB.
+     */
+    class TokenBuffer {
+    public:
+        /*!
+         * \brief Builds an empty buffer without a source. Only tokens without a value can be stored on it
+         */
+        explicit TokenBuffer() = default;
+
+        /*!
+         * \brief Builds an empty buffer for the tokens of a source
+         * \param file The id of the file the tokens come from
+         * \param source The bytes of the source. They must outlive the buffer
+         */
+        explicit TokenBuffer(tiny::FileId file, std::string_view source) : file(file), source(source) {};
+
+        /*!
+         * \brief Appends a Lexeme
+         * \param l The Lexeme. Its value must be a view into the buffer's source
+         */
+        void push(const tiny::Lexeme &l);
+
+        /*!
+         * \brief Appends a token
+         * \param t The token. Its value must be a view into the buffer's source
+         */
+        void push(const tiny::TokenRef &t);
+
+        /*!
+         * \brief Appends the tokens of another buffer, moving their offsets
+         * \param other The buffer to copy the tokens from. Its source doesn't need to be alive
+         * \param from Position of the first token to copy
+         * \param to Position after the last token to copy
+         * \param shift Bytes to add to the offsets of the tokens. The moved values must be inside the buffer's source
+         *
+         * Copies the tokens as offsets, without going through their values, so it can be used to carry tokens over to
+         * an edited version of their source.
+         */
+        void append(const tiny::TokenBuffer &other, std::size_t from, std::size_t to, std::int64_t shift);
+
+        /*!
+         * \brief Replaces the token at a position
+         * \param i Position of the token
+         * \param l The new token. Its value must be a view into the buffer's source
+         */
+        void set(std::size_t i, const tiny::Lexeme &l);
+
+        /*!
+         * \brief Replaces the token at a position
+         * \param i Position of the token
+         * \param t The new token. Its value must be a view into the buffer's source
+         */
+        void set(std::size_t i, const tiny::TokenRef &t);
+
+        /*!
+         * \brief Changes the number of tokens. New tokens are None
+         * \param n The number of tokens
+         */
+        void resize(std::size_t n);
+
+        /*!
+         * \brief Removes all the tokens
+         */
+        void clear() {
+            resize(0);
+        }
+
+        /*!
+         * \brief Gets the token at a position
+         * \param i Position of the token. Must be lower than size()
+         * \return A handle to the token
+         */
+        [[nodiscard]] tiny::TokenRef operator[](std::size_t i) const {
+            return tiny::TokenRef{tokens[i], getValue(i), getNumber(i), starts[i], ends[i], this};
+        }
+
+        /*!
+         * \brief Gets the number of tokens
+         * \return The number of tokens
+         */
+        [[nodiscard]] std::size_t size() const {
+            return tokens.size();
+        }
+
+        /*!
+         * \brief Checks whether the buffer has tokens
+         * \return True if it has no tokens
+         */
+        [[nodiscard]] bool empty() const {
+            return tokens.empty();
+        }
+
+        /*!
+         * \brief Gets the file of the tokens
+         * \return The id of the file the tokens come from
+         */
+        [[nodiscard]] tiny::FileId getFile() const {
+            return file;
+        }
+
+    private:
+        /*!
+         * \brief Stores the fields of a token
+         * \param i Position of the token
+         * \param token The Token
+         * \param value The view of the value. Must be empty or inside the source
+         * \param number The decoded value of a numeric literal
+         * \param start Byte offset of the token start
+         * \param end Byte offset of the token end
+         */
+        void store(std::size_t i, tiny::Token token, std::string_view value, const tiny::Number &number,
+                   std::uint64_t start, std::uint64_t end);
+
+        /*!
+         * \brief Rebuilds the view of a value
+         * \param i Position of the token
+         * \return A view into the source
+         */
+        [[nodiscard]] std::string_view getValue(std::size_t i) const {
+            if (valueLengths[i] == 0) {
+                return {};
+            }
+
+            return source.substr(valueStarts[i], valueLengths[i]);
+        }
+
+        /*!
+         * \brief Finds the decoded value of a numeric literal
+         * \param i Position of the token
+         * \return Position in numbers of the first entry of a token at i or after it
+         */
+        [[nodiscard]] std::size_t findNumber(std::size_t i) const {
+            auto it = std::lower_bound(numbers.begin(), numbers.end(), i, [](const auto &entry, std::size_t pos) {
+                return entry.first < pos;
+            });
+
+            return std::size_t(it - numbers.begin());
+        }
+
+        /*!
+         * \brief Gets the decoded value of a token
+         * \param i Position of the token
+         * \return The value of the numeric literal, or zero for any other token
+         */
+        [[nodiscard]] tiny::Number getNumber(std::size_t i) const {
+            if (tokens[i] != tiny::Token::LiteralNum) {
+                return {};
+            }
+
+            auto at = findNumber(i);
+            return at < numbers.size() && numbers[at].first == i ? numbers[at].second : tiny::Number();
+        }
+
+        //! Id of the file the tokens come from
+        tiny::FileId file = 0;
+
+        //! The bytes of the source
+        std::string_view source;
+
+        //! Token of each token
+        std::vector<tiny::Token> tokens;
+
+        //! Byte offset of the start of each token
+        std::vector<std::uint32_t> starts;
+
+        //! Byte offset of the end of each token
+        std::vector<std::uint32_t> ends;
+
+        //! Byte offset of the value of each token inside the source
+        std::vector<std::uint32_t> valueStarts;
+
+        //! Byte length of the value of each token
+        std::vector<std::uint32_t> valueLengths;
+
+        //! Decoded value of the numeric literals, sorted by the position of their token. Other tokens have no entry
+        std::vector<std::pair<std::uint32_t, tiny::Number>> numbers;
+    };
+}
+
+#endif //TINY_TOKENBUFFER_H
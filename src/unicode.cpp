@@ -1,40 +1,106 @@
 #include "unicode.h"
 
-tiny::String::String(const std::istream &stream) {
-    std::istreambuf_iterator<char> it(stream.rdbuf());
-    std::istreambuf_iterator<char> eos;
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 
-    try {
-        for (std::uint32_t val = utf8::next(it, eos); val; val = utf8::next(it, eos)) {
-            codepoints.push_back(val);
-        }
+#include "decoder.h"
+#include "errors.h"
+
+tiny::String::String(const String &str) {
+    *this = str;
+}
+
+tiny::String::String(String &&str) noexcept {
+    *this = std::move(str);
+}
+
+tiny::String &tiny::String::operator=(const String &str) {
+    if (this == &str) {
+        return *this;
     }
-    catch (const utf8::not_enough_room &) {
-        // Sometimes this exception is thrown on EOF. Seems to be a bug on the library. Ignore for now.
+
+    length = 0;
+    wide = str.wide;
+    grow(str.length * (wide ? 4 : 1));
+    std::memcpy(bytes(), str.bytes(), str.length * (wide ? 4 : 1));
+
+    length = str.length;
+    hashed = str.hashed;
+    cachedHash = str.cachedHash;
+
+    return *this;
+}
+
+tiny::String &tiny::String::operator=(String &&str) noexcept {
+    if (this == &str) {
+        return *this;
     }
+
+    release();
+
+    // Both the inline buffer and the heap pointer are trivially copyable
+    storage = str.storage;
+    length = str.length;
+    capacity = str.capacity;
+    wide = str.wide;
+    hashed = str.hashed;
+    cachedHash = str.cachedHash;
+
+    // Leave the moved-from string empty, so it doesn't free the storage that's now ours
+    str.capacity = INLINE_CAPACITY;
+    str.length = 0;
+    str.wide = false;
+    str.hashed = false;
+
+    return *this;
+}
+
+tiny::String::~String() {
+    release();
+}
+
+tiny::String::String(const std::istream &stream) {
+    std::string bytes(std::istreambuf_iterator<char>(stream.rdbuf()), std::istreambuf_iterator<char>{});
+    *this = tiny::String(std::string_view(bytes));
 }
 
 tiny::String::String(std::string_view str) {
-    auto it = str.begin();
+    // Most strings are plain ASCII, so they can be copied as-is into the narrow layout without widening them
+    std::size_t ascii = tiny::scanASCII(str);
+    grow(ascii);
+    std::memcpy(bytes(), str.data(), ascii);
+    length = std::uint32_t(ascii);
 
-    try {
-        for (std::uint32_t val = utf8::next(it, str.end()); val; val = utf8::next(it, str.end())) {
-            codepoints.push_back(val);
-        }
+    if (ascii == str.size() || str[ascii] == '\0') {
+        return;
     }
-    catch (const utf8::not_enough_room &) {
-        // Sometimes this exception is thrown on EOF. Seems to be a bug on the library. Ignore for now.
+
+    std::vector<std::uint32_t> rest;
+    try {
+        tiny::decodeUTF8(str.substr(ascii), rest);
+    } catch (const tiny::DecodeError &e) {
+        // The decoder only saw the bytes after the ASCII prefix, so its offset is relative to them
+        throw tiny::DecodeError(e.reason, ascii + e.offset);
     }
+
+    append(rest.data(), rest.size());
 }
 
 tiny::String::String(std::uint32_t c)
 {
-    codepoints.push_back(c);
+    push(c);
+}
+
+tiny::String::String(const std::vector<std::uint32_t> &cps) {
+    append(cps.data(), cps.size());
 }
 
 std::string tiny::String::toString() const {
     std::string str;
-    for (auto const &codepoint: codepoints) {
+    str.reserve(length);
+
+    for (auto const &codepoint: *this) {
         if (codepoint <= 0x7f)
             str.append(1, static_cast<char>(codepoint));
         else if (codepoint <= 0x7ff) {
@@ -57,5 +123,179 @@ std::string tiny::String::toString() const {
 
 std::vector<std::uint32_t> tiny::String::data() const
 {
-    return codepoints;
+    return {begin(), end()};
+}
+
+void tiny::String::reserve(std::size_t n) {
+    grow(n * (wide ? 4 : 1));
+}
+
+void tiny::String::push(std::uint32_t c) {
+    hashed = false;
+
+    if (!wide && c > 0xff) {
+        widen(1);
+    } else if ((length + 1) * (wide ? 4 : 1) > capacity) {
+        grow((length + 1) * (wide ? 4 : 1));
+    }
+
+    if (wide) {
+        words()[length] = c;
+    } else {
+        bytes()[length] = static_cast<unsigned char>(c);
+    }
+
+    length++;
+}
+
+std::size_t tiny::String::hash() const {
+    if (hashed) {
+        return cachedHash;
+    }
+
+    // FNV-1a over the codepoints, so the result doesn't depend on the layout
+    std::uint64_t h = 0xcbf29ce484222325;
+    for (std::size_t i = 0; i < length; i++) {
+        h ^= at(i);
+        h *= 0x100000001b3;
+    }
+
+    cachedHash = std::size_t(h);
+    hashed = true;
+
+    return cachedHash;
+}
+
+bool tiny::String::operator<(const tiny::String &str2) const {
+    std::size_t common = (std::min)(length, str2.length);
+
+    if (!wide && !str2.wide) {
+        // Byte order is codepoint order for the narrow layout
+        int cmp = std::memcmp(bytes(), str2.bytes(), common);
+        return cmp < 0 || (cmp == 0 && length < str2.length);
+    }
+
+    for (std::size_t i = 0; i < common; i++) {
+        if (at(i) != str2.at(i)) {
+            return at(i) < str2.at(i);
+        }
+    }
+
+    return length < str2.length;
+}
+
+bool tiny::String::operator==(const tiny::String &str) const {
+    if (length != str.length || wide != str.wide) {
+        // A string is only wide if it holds a codepoint over U+00FF, so strings with different layouts can't be equal
+        return false;
+    }
+
+    if (hashed && str.hashed && cachedHash != str.cachedHash) {
+        return false;
+    }
+
+    return std::memcmp(bytes(), str.bytes(), length * (wide ? 4 : 1)) == 0;
+}
+
+void tiny::String::grow(std::size_t needed) {
+    if (needed <= capacity) {
+        return;
+    }
+
+    std::size_t newCapacity = (std::max)(needed, std::size_t(capacity) * 2);
+    newCapacity = (newCapacity + 3) & ~std::size_t(3); // Keep it a whole number of words
+
+    auto *newWords = new std::uint32_t[newCapacity / 4];
+    std::memcpy(newWords, words(), length * (wide ? 4 : 1));
+
+    release();
+    storage.heap = newWords;
+    capacity = std::uint32_t(newCapacity);
+}
+
+void tiny::String::widen(std::size_t extra) {
+    std::size_t needed = (length + extra) * 4;
+
+    std::size_t newCapacity = INLINE_CAPACITY;
+    if (needed > INLINE_CAPACITY) {
+        newCapacity = ((std::max)(needed, std::size_t(capacity) * 2) + 3) & ~std::size_t(3);
+    }
+
+    // When staying inline the codepoints are widened into a temporary, since they'd overlap in place
+    std::uint32_t wideBuffer[INLINE_CAPACITY / 4];
+    std::uint32_t *target = newCapacity == INLINE_CAPACITY ? wideBuffer : new std::uint32_t[newCapacity / 4];
+
+    const unsigned char *narrow = bytes();
+    for (std::size_t i = 0; i < length; i++) {
+        target[i] = narrow[i];
+    }
+
+    release();
+    wide = true;
+
+    if (target == wideBuffer) {
+        std::memcpy(storage.local, wideBuffer, length * 4);
+    } else {
+        storage.heap = target;
+        capacity = std::uint32_t(newCapacity);
+    }
+}
+
+void tiny::String::append(const std::uint32_t *cps, std::size_t n) {
+    if (n == 0) {
+        return;
+    }
+
+    hashed = false;
+
+    if (!wide && std::any_of(cps, cps + n, [](std::uint32_t c) { return c > 0xff; })) {
+        widen(n);
+    } else {
+        grow((length + n) * (wide ? 4 : 1));
+    }
+
+    if (wide) {
+        std::memcpy(words() + length, cps, n * 4);
+    } else {
+        unsigned char *narrow = bytes() + length;
+        for (std::size_t i = 0; i < n; i++) {
+            narrow[i] = static_cast<unsigned char>(cps[i]);
+        }
+    }
+
+    length += std::uint32_t(n);
+}
+
+void tiny::String::append(const tiny::String &str) {
+    if (str.empty()) {
+        return;
+    }
+
+    if (str.wide) {
+        append(str.words(), str.length);
+        return;
+    }
+
+    hashed = false;
+    grow((length + str.length) * (wide ? 4 : 1));
+
+    if (wide) {
+        std::uint32_t *target = words() + length;
+        const unsigned char *narrow = str.bytes();
+        for (std::size_t i = 0; i < str.length; i++) {
+            target[i] = narrow[i];
+        }
+    } else {
+        std::memcpy(bytes() + length, str.bytes(), str.length);
+    }
+
+    length += str.length;
+}
+
+void tiny::String::release() {
+    if (!isInline()) {
+        delete[] storage.heap;
+    }
+
+    capacity = INLINE_CAPACITY;
 }
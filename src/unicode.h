@@ -6,25 +6,83 @@
 #include <vector>
 #include <sstream>
 #include <cstdint>
-
-#include "utf8.h"
+#include <functional>
+#include <iterator>
 
 namespace tiny {
+    /*!
+     * \brief A String holds a sequence of Unicode codepoints
+     *
+     * A String holds a sequence of Unicode codepoints. Short strings are stored inline and don't allocate. As long as
+     * every codepoint fits in a byte (Latin-1, so ASCII included) the string is stored with one byte per codepoint,
+     * and it's only widened to four bytes per codepoint once a codepoint over U+00FF is added. Comparisons are done
+     * codepoint by codepoint, and the hash is computed on demand and cached until the string is modified.
+     */
     class String {
     public:
-        std::vector<std::uint32_t> codepoints = {};
+        //! Read-only iterator over the codepoints of a String
+        class const_iterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = std::uint32_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const std::uint32_t *;
+            using reference = std::uint32_t;
+
+            const_iterator(const tiny::String *str, std::size_t i) : str(str), i(i) {};
+
+            std::uint32_t operator*() const {
+                return str->at(i);
+            }
+
+            const_iterator &operator++() {
+                i++;
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                auto prev = *this;
+                i++;
+                return prev;
+            }
+
+            bool operator==(const const_iterator &rhs) const {
+                return str == rhs.str && i == rhs.i;
+            }
+
+            bool operator!=(const const_iterator &rhs) const {
+                return !(*this == rhs);
+            }
+
+        private:
+            //! The iterated string
+            const tiny::String *str;
+
+            //! Index of the current codepoint
+            std::size_t i;
+        };
 
         explicit String() = default;
 
+        String(const String &str);
+        String(String &&str) noexcept;
+        String &operator=(const String &str);
+        String &operator=(String &&str) noexcept;
+        ~String();
+
         /*!
          * \brief Transforms a char stream into a unicode string
          * \param stream An UTF-8 encoded char stream
+         *
+         * Reads the stream up to its end or its first NUL byte. Throws DecodeError if the stream isn't valid UTF-8.
          */
         explicit String(const std::istream &stream);
 
         /*!
          * \brief Transforms a std::string into a unicode string
          * \param str A UTF-8 encoded std::string
+         *
+         * Reads the string up to its end or its first NUL byte. Throws DecodeError if the string isn't valid UTF-8.
          */
         explicit String(std::string_view str);
 
@@ -34,6 +92,12 @@ namespace tiny {
          */
         explicit String(std::uint32_t c);
 
+        /*!
+         * \brief Builds a unicode string from a sequence of codepoints
+         * \param cps The codepoints of the string
+         */
+        explicit String(const std::vector<std::uint32_t> &cps);
+
         /*!
          * \brief Transforms a C-string into a unicode string
          * \param str A UTF-8 encoded C-string
@@ -53,50 +117,98 @@ namespace tiny {
         [[nodiscard]] std::vector<std::uint32_t> data() const;
 
         /*!
-         * \brief Less-than operator for UnicodeStrings. Uses the std::string implementation
+         * \brief Gets the number of codepoints in the string
+         * \return The length of the string in codepoints
+         */
+        [[nodiscard]] std::size_t size() const {
+            return length;
+        }
+
+        /*!
+         * \brief Checks whether the string has no codepoints
+         * \return True if the string is empty
+         */
+        [[nodiscard]] bool empty() const {
+            return length == 0;
+        }
+
+        /*!
+         * \brief Checks whether the string is stored with four bytes per codepoint
+         * \return True if the string holds a codepoint over U+00FF
+         */
+        [[nodiscard]] bool isWide() const {
+            return wide;
+        }
+
+        /*!
+         * \brief Returns the i-th codepoint in the string
+         * \param i Index of the codepoint. Must be smaller than size()
+         * \return The codepoint
+         */
+        [[nodiscard]] std::uint32_t at(std::size_t i) const {
+            return wide ? words()[i] : bytes()[i];
+        }
+
+        /*!
+         * \brief Makes room for a number of codepoints without further allocations
+         * \param n The number of codepoints to make room for
+         */
+        void reserve(std::size_t n);
+
+        /*!
+         * \brief Adds a codepoint to the end of the string
+         * \param c The codepoint to add
+         */
+        void push(std::uint32_t c);
+
+        /*!
+         * \brief Gets the hash of the string
+         * \return The hash of the codepoints. Computed once and cached until the string changes
+         */
+        [[nodiscard]] std::size_t hash() const;
+
+        [[nodiscard]] const_iterator begin() const {
+            return {this, 0};
+        }
+
+        [[nodiscard]] const_iterator end() const {
+            return {this, length};
+        }
+
+        /*!
+         * \brief Less-than operator for Strings. Compares codepoint by codepoint
          */
-        [[nodiscard]] bool operator < (const tiny::String &str2) const {
-             return toString() < str2.toString();
-         }
+        [[nodiscard]] bool operator < (const tiny::String &str2) const;
 
         /*!
         * \brief Adds a char to the string
         */
         void operator += (const std::uint32_t &c) {
-            codepoints.push_back(c);
+            push(c);
         }
 
         /*!
         * \brief Adds a char to the string
         */
         tiny::String operator + (const char cStr[]) const {
-            std::vector<std::uint32_t> codepointsCopy(codepoints);
-            for(char const* it = cStr; *it; ++it) {
-                codepointsCopy.push_back(*it);
-            }
-
-            tiny::String newString;
-            newString.codepoints = codepointsCopy;
-
-            return newString;
+            return *this + tiny::String(cStr);
         }
 
         /*!
         * \brief Appends a string
         */
         void operator += (const tiny::String &str) {
-            codepoints.insert(codepoints.end(), str.codepoints.begin(), str.codepoints.end());
+            append(str);
         }
 
         /*!
         * \brief Appends a tiny::String
         */
         tiny::String operator + (const tiny::String &str) const {
-            std::vector<std::uint32_t> codepointsCopy(codepoints);
-            codepointsCopy.insert(codepointsCopy.end(), str.codepoints.begin(), str.codepoints.end());
-
             tiny::String newString;
-            newString.codepoints = codepointsCopy;
+            newString.reserve(length + str.length);
+            newString.append(*this);
+            newString.append(str);
 
             return newString;
         }
@@ -105,39 +217,116 @@ namespace tiny {
         * \brief Appends a std::string
         */
         tiny::String operator + (const std::string &str) const {
-            tiny::String newString;
-            std::vector<std::uint32_t> codepointsCopy(codepoints);
-            newString.codepoints = codepointsCopy;
-
-            return newString + tiny::String(str);
+            return *this + tiny::String(std::string_view(str));
         }
 
         /*!
         * \brief Compares two strings
         */
-        [[nodiscard]] bool operator == (const tiny::String &str) const {
-            return codepoints == str.codepoints;
-        }
+        [[nodiscard]] bool operator == (const tiny::String &str) const;
 
         /*!
         * \brief Asserts the difference between two strings
         */
         [[nodiscard]] bool operator != (const tiny::String &str) const {
-            return codepoints != str.codepoints;
+            return !(*this == str);
         }
 
         /*!
         * \brief Checks whether a string contains anything
         */
         [[nodiscard]] explicit operator bool() const {
-            return codepoints.empty();
+            return empty();
         }
 
         /*!
         * \brief Returns the i-th codepoint in the string
         */
         [[nodiscard]] std::uint32_t  operator [](const int &i) const {
-            return codepoints[i];
+            return at(std::size_t(i));
+        }
+
+    private:
+        //! Size in bytes of the inline storage
+        static constexpr std::size_t INLINE_CAPACITY = 16;
+
+        //! Inline buffer or heap allocation, depending on the capacity
+        union {
+            std::uint32_t local[INLINE_CAPACITY / sizeof(std::uint32_t)];
+            std::uint32_t *heap;
+        } storage{};
+
+        //! Number of codepoints in the string
+        std::uint32_t length = 0;
+
+        //! Capacity in bytes. The string is stored inline as long as it's INLINE_CAPACITY
+        std::uint32_t capacity = INLINE_CAPACITY;
+
+        //! Whether the codepoints are stored in four bytes instead of one
+        bool wide = false;
+
+        //! Whether cachedHash is up-to-date
+        mutable bool hashed = false;
+
+        //! Hash of the string, valid only if hashed is set
+        mutable std::size_t cachedHash = 0;
+
+        [[nodiscard]] bool isInline() const {
+            return capacity == INLINE_CAPACITY;
+        }
+
+        [[nodiscard]] std::uint32_t *words() {
+            return isInline() ? storage.local : storage.heap;
+        }
+
+        [[nodiscard]] const std::uint32_t *words() const {
+            return isInline() ? storage.local : storage.heap;
+        }
+
+        [[nodiscard]] unsigned char *bytes() {
+            return reinterpret_cast<unsigned char *>(words());
+        }
+
+        [[nodiscard]] const unsigned char *bytes() const {
+            return reinterpret_cast<const unsigned char *>(words());
+        }
+
+        /*!
+         * \brief Grows the storage to at least the given number of bytes, keeping its contents
+         * \param needed The minimum capacity in bytes
+         */
+        void grow(std::size_t needed);
+
+        /*!
+         * \brief Switches the storage to four bytes per codepoint
+         * \param extra Number of codepoints to make room for, on top of the current ones
+         */
+        void widen(std::size_t extra);
+
+        /*!
+         * \brief Appends a sequence of codepoints
+         * \param cps The codepoints to append
+         * \param n Number of codepoints
+         */
+        void append(const std::uint32_t *cps, std::size_t n);
+
+        /*!
+         * \brief Appends another string
+         * \param str The string to append
+         */
+        void append(const tiny::String &str);
+
+        //! Frees the heap storage, if any, and goes back to the inline storage. Doesn't touch the length
+        void release();
+    };
+}
+
+namespace std {
+    //! Allows tiny::String to be used as the key of unordered containers
+    template<>
+    struct hash<tiny::String> {
+        std::size_t operator()(const tiny::String &str) const noexcept {
+            return str.hash();
         }
     };
 }
@@ -0,0 +1,243 @@
+#ifndef TINY_VISITOR_H
+#define TINY_VISITOR_H
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ast.h"
+
+namespace tiny {
+    /*!
+     * \brief Selects the hooks of a pass for one type of node
+     * \tparam T The type of node
+     */
+    template<tiny::ASTNodeType T>
+    using NodeTag = std::integral_constant<tiny::ASTNodeType, T>;
+
+    //! Number of values of ASTNodeType
+    inline constexpr std::size_t AST_NODE_TYPE_COUNT = std::size_t(tiny::ASTNodeType::Composition) + 1;
+
+    //! Whether a pass declares an enter hook for a type of node
+    template<typename P, tiny::ASTNodeType T, typename = void>
+    struct HasEnterHook : std::false_type {};
+
+    template<typename P, tiny::ASTNodeType T>
+    struct HasEnterHook<P, T, std::void_t<decltype(std::declval<P &>().enter(
+            tiny::NodeTag<T>(), std::declval<tiny::ConstNodeRef>(), std::declval<tiny::ConstNodeRef>()))>>
+            : std::true_type {};
+
+    //! Whether a pass declares a leave hook for a type of node
+    template<typename P, tiny::ASTNodeType T, typename = void>
+    struct HasLeaveHook : std::false_type {};
+
+    template<typename P, tiny::ASTNodeType T>
+    struct HasLeaveHook<P, T, std::void_t<decltype(std::declval<P &>().leave(
+            tiny::NodeTag<T>(), std::declval<tiny::ConstNodeRef>(), std::declval<tiny::ConstNodeRef>()))>>
+            : std::true_type {};
+
+    /*!
+     * \brief The hooks of a pass, resolved at compile time for every ASTNodeType
+     * \tparam P The pass
+     *
+     * A pass declares its hooks as member functions named enter and leave, which take a NodeTag, the node and its
+     * parent (a handle to no node for the root of the walk):
+     *
+     *    bool enter(tiny::NodeTag<tiny::ASTNodeType::Identifier>, tiny::ConstNodeRef node, tiny::ConstNodeRef parent);
+     *    void leave(tiny::NodeTag<tiny::ASTNodeType::Identifier>, tiny::ConstNodeRef node, tiny::ConstNodeRef parent);
+     *
+     * enter runs before the children of the node and leave after them. When enter returns false the children and the
+     * leave hook of the node are skipped, and enter may also return void to always descend. A template over the
+     * NodeTag's type serves as a fallback for the types without a hook of their own, and types without any hook are
+     * visited without calling into the pass.
+     */
+    template<typename P>
+    class PassHooks {
+    public:
+        /*!
+         * \brief Calls the enter hook of a pass for a node
+         * \param pass The pass
+         * \param node The node
+         * \param parent The parent of the node
+         * \return False if the pass skips the children of the node
+         */
+        static bool enter(P &pass, tiny::ConstNodeRef node, tiny::ConstNodeRef parent) {
+            static constexpr auto hooks = enterTable(std::make_index_sequence<tiny::AST_NODE_TYPE_COUNT>());
+            return hooks[std::size_t(node->type)](pass, node, parent);
+        }
+
+        /*!
+         * \brief Calls the leave hook of a pass for a node
+         * \param pass The pass
+         * \param node The node
+         * \param parent The parent of the node
+         */
+        static void leave(P &pass, tiny::ConstNodeRef node, tiny::ConstNodeRef parent) {
+            static constexpr auto hooks = leaveTable(std::make_index_sequence<tiny::AST_NODE_TYPE_COUNT>());
+            hooks[std::size_t(node->type)](pass, node, parent);
+        }
+
+    private:
+        template<tiny::ASTNodeType T>
+        static bool enterAs(P &pass, tiny::ConstNodeRef node, tiny::ConstNodeRef parent) {
+            if constexpr (!tiny::HasEnterHook<P, T>::value) {
+                return true;
+            } else if constexpr (std::is_void_v<decltype(pass.enter(tiny::NodeTag<T>(), node, parent))>) {
+                pass.enter(tiny::NodeTag<T>(), node, parent);
+                return true;
+            } else {
+                return pass.enter(tiny::NodeTag<T>(), node, parent);
+            }
+        }
+
+        template<tiny::ASTNodeType T>
+        static void leaveAs(P &pass, tiny::ConstNodeRef node, tiny::ConstNodeRef parent) {
+            if constexpr (tiny::HasLeaveHook<P, T>::value) {
+                pass.leave(tiny::NodeTag<T>(), node, parent);
+            }
+        }
+
+        template<std::size_t... I>
+        static constexpr auto enterTable(std::index_sequence<I...>) {
+            return std::array<bool (*)(P &, tiny::ConstNodeRef, tiny::ConstNodeRef), sizeof...(I)>{
+                    &enterAs<tiny::ASTNodeType(I)>...};
+        }
+
+        template<std::size_t... I>
+        static constexpr auto leaveTable(std::index_sequence<I...>) {
+            return std::array<void (*)(P &, tiny::ConstNodeRef, tiny::ConstNodeRef), sizeof...(I)>{
+                    &leaveAs<tiny::ASTNodeType(I)>...};
+        }
+    };
+
+    //! Calls a function with the index and a reference of every pass in a tuple
+    template<typename Tuple, typename F, std::size_t... I>
+    void forEachPass(Tuple &passes, F &&f, std::index_sequence<I...>) {
+        (f(I, std::get<I>(passes)), ...);
+    }
+
+    /*!
+     * \brief Runs several passes over a subtree in a single traversal
+     * \param root The root of the subtree
+     * \param passes The passes. Their hooks are called in the given order for every node
+     *
+     * Every pass sees the same hooks it would see if it walked the tree on its own: a pass that skips a subtree isn't
+     * called for any node inside of it, while the rest keep visiting it. The subtree is only left out of the traversal
+     * once every pass skipped it. The walk keeps its state on the heap, so it isn't limited by the depth of the tree.
+     */
+    template<typename... Passes>
+    void visit(tiny::ConstNodeRef root, Passes &...passes) {
+        static_assert(sizeof...(Passes) > 0, "At least one pass is needed");
+        constexpr auto NOT_SKIPPING = std::numeric_limits<std::size_t>::max();
+
+        const auto &arena = *root.getArena();
+        std::tuple<Passes &...> all(passes...);
+        auto indices = std::index_sequence_for<Passes...>();
+
+        // Depth of the node whose subtree each pass skips
+        std::array<std::size_t, sizeof...(Passes)> skipFrom{};
+        skipFrom.fill(NOT_SKIPPING);
+
+        // Ids of the ancestors of the current node
+        std::vector<tiny::NodeId> path;
+        auto parentOf = [&]() {
+            return path.empty() ? tiny::ConstNodeRef() : arena.get(path.back());
+        };
+
+        arena.walk(root.getId(), [&](tiny::NodeId id) {
+            auto node = arena.get(id);
+            auto parent = parentOf();
+            auto depth = path.size();
+
+            bool descend = false;
+            tiny::forEachPass(all, [&](std::size_t i, auto &pass) {
+                if (skipFrom[i] != NOT_SKIPPING) {
+                    return;
+                }
+
+                if (tiny::PassHooks<std::decay_t<decltype(pass)>>::enter(pass, node, parent)) {
+                    descend = true;
+                } else {
+                    skipFrom[i] = depth;
+                }
+            }, indices);
+
+            if (!descend) {
+                // The node won't be left, so the passes that skipped it are done with it here
+                for (auto &s: skipFrom) {
+                    if (s == depth) {
+                        s = NOT_SKIPPING;
+                    }
+                }
+
+                return false;
+            }
+
+            path.push_back(id);
+            return true;
+        }, [&](tiny::NodeId id) {
+            path.pop_back();
+
+            auto node = arena.get(id);
+            auto parent = parentOf();
+            auto depth = path.size();
+
+            tiny::forEachPass(all, [&](std::size_t i, auto &pass) {
+                if (skipFrom[i] == depth) {
+                    skipFrom[i] = NOT_SKIPPING;
+                } else if (skipFrom[i] == NOT_SKIPPING) {
+                    tiny::PassHooks<std::decay_t<decltype(pass)>>::leave(pass, node, parent);
+                }
+            }, indices);
+        });
+    }
+
+    /*!
+     * \brief Runs several passes over every statement of a file in a single traversal
+     * \param file The file
+     * \param passes The passes
+     */
+    template<typename... Passes>
+    void visit(const tiny::ASTFile &file, Passes &...passes) {
+        for (auto s: file.statements) {
+            tiny::visit(file.nodes.get(s), passes...);
+        }
+    }
+
+    /*!
+     * \brief Base of the passes over an AST
+     * \tparam Derived The pass, which declares its hooks as described in PassHooks
+     *
+     * A Pass can be run on its own, or fused with others through tiny::visit so that all of them share one traversal.
+     */
+    template<typename Derived>
+    class Pass {
+    public:
+        /*!
+         * \brief Runs the pass on its own over every statement of a file
+         * \param file The file
+         */
+        void run(const tiny::ASTFile &file) {
+            tiny::visit(file, derived());
+        }
+
+        /*!
+         * \brief Runs the pass on its own over a subtree
+         * \param root The root of the subtree
+         */
+        void run(tiny::ConstNodeRef root) {
+            tiny::visit(root, derived());
+        }
+
+    private:
+        Derived &derived() {
+            return static_cast<Derived &>(*this);
+        }
+    };
+}
+
+#endif //TINY_VISITOR_H
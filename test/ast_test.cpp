@@ -0,0 +1,144 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "ast.h"
+#include "errors.h"
+
+TEST(AST, ArenaLinksChildren) {
+    tiny::ASTArena arena;
+
+    auto lhs = arena.add(tiny::ASTNode(tiny::Metadata(), tiny::ASTNodeType::LiteralInt, std::int64_t(1)));
+    auto rhs = arena.add(tiny::ASTNode(tiny::Metadata(), tiny::ASTNodeType::Identifier, tiny::Symbol("x")));
+    auto op = arena.add(tiny::ASTNode(tiny::Metadata(), tiny::ASTNodeType::OpAddition));
+    op.addChildren(lhs);
+    op.addChildren(rhs);
+
+    // Changes to a child after linking it are seen by the parent, since nothing is copied
+    rhs->val = tiny::Symbol("y");
+
+    ASSERT_EQ(arena.size(), 3);
+    ASSERT_EQ(op.getFirstChild().getId(), lhs.getId());
+    ASSERT_EQ(op.getSecondChild()->getStringVal(), tiny::Symbol("y"));
+    ASSERT_EQ(op.getChild(tiny::ASTNodeType::Identifier).getId(), rhs.getId());
+
+    std::vector<tiny::NodeId> children;
+    for (auto c: op.children()) {
+        children.push_back(c.getId());
+    }
+
+    ASSERT_EQ(children, (std::vector<tiny::NodeId>{lhs.getId(), rhs.getId()}));
+    ASSERT_TRUE(lhs.children().empty());
+
+    ASSERT_THROW((void) lhs.getFirstChild(), tiny::NoSuchChild);
+    ASSERT_THROW((void) op.getChild(tiny::ASTNodeType::LiteralString), tiny::NoSuchChild);
+
+    const auto &constArena = arena;
+    tiny::ConstNodeRef root = constArena.get(op.getId());
+    ASSERT_EQ(root.toJson()["children"].size(), 2);
+    ASSERT_EQ(root.toJson()["children"][1]["value"], "y");
+}
+
+TEST(AST, CompactValues) {
+    ASSERT_LE(sizeof(tiny::Value), 16);
+
+    ASSERT_EQ(tiny::Value().get<tiny::Symbol>(), tiny::Symbol());
+    ASSERT_EQ(tiny::Value(tiny::Symbol("x")).get<tiny::Symbol>(), tiny::Symbol("x"));
+    ASSERT_EQ(tiny::Value(std::int64_t(-3)).get<std::int64_t>(), -3);
+    ASSERT_EQ(tiny::Value(std::uint64_t(3)).get<std::uint64_t>(), 3);
+    ASSERT_TRUE(tiny::Value(true).get<bool>());
+
+    // Decimals are held by the arena and freed along with it
+    tiny::ASTArena arena;
+    tiny::Value decimal = arena.addDecimal(1.5L);
+    ASSERT_EQ(arena.getDecimal(decimal.get<tiny::DecimalId>()), 1.5L);
+    ASSERT_EQ(arena.toString(decimal), "1.500000");
+    ASSERT_EQ(decimal, tiny::Value(decimal.get<tiny::DecimalId>()));
+    ASSERT_THROW((void) tiny::toString(decimal), std::bad_variant_access);
+
+    ASSERT_NE(tiny::Value(std::int64_t(0)), tiny::Value(false));
+    ASSERT_THROW((void) tiny::Value(true).get<std::int64_t>(), std::bad_variant_access);
+}
+
+TEST(AST, FlagParameters) {
+    tiny::ASTNode node(tiny::Metadata(), tiny::ASTNodeType::Type);
+    node.addParam(tiny::Parameter(tiny::ParameterType::ValueAt));
+    node.addParam(tiny::Parameter(tiny::ParameterType::Type, tiny::Symbol("int")));
+    node.addParam(tiny::Parameter(tiny::ParameterType::Const));
+
+    ASSERT_TRUE(node.hasParam(tiny::ParameterType::Const));
+    ASSERT_FALSE(node.hasParam(tiny::ParameterType::Pointer));
+    ASSERT_EQ(node.getParam(tiny::ParameterType::Type).getStringVal(node.meta), tiny::Symbol("int"));
+    ASSERT_THROW((void) node.getParam(tiny::ParameterType::Pointer), tiny::NoSuchParameter);
+
+    std::vector<tiny::ParameterType> types;
+    for (auto &p: node.getParams()) {
+        types.push_back(p.type);
+    }
+
+    ASSERT_EQ(types, (std::vector<tiny::ParameterType>{tiny::ParameterType::Type, tiny::ParameterType::Const,
+                                                       tiny::ParameterType::ValueAt}));
+
+    // Only one parameter can carry a value
+    ASSERT_THROW(node.addParam(tiny::Parameter(tiny::ParameterType::RangeIdentifier, tiny::Symbol("i"))),
+                 tiny::BadASTError);
+
+    // Flags can't carry one
+    ASSERT_THROW(node.addParam(tiny::Parameter(tiny::ParameterType::Pointer, true)), tiny::BadASTError);
+}
+
+TEST(AST, EmptyValuedParameter) {
+    // A valued parameter is kept as such even when its value is empty
+    tiny::ASTNode node(tiny::Metadata(), tiny::ASTNodeType::FunctionDeclaration);
+    node.addParam(tiny::Parameter(tiny::ParameterType::Name, tiny::Symbol()));
+
+    ASSERT_TRUE(node.hasParam(tiny::ParameterType::Name));
+    ASSERT_EQ(node.getParam(tiny::ParameterType::Name).getStringVal(node.meta), tiny::Symbol());
+    ASSERT_EQ(node.flags, 0);
+    ASSERT_EQ(node.getParams().size(), 1);
+
+    // And it still takes the single slot for valued parameters
+    ASSERT_THROW(node.addParam(tiny::Parameter(tiny::ParameterType::Type, tiny::Symbol("int"))), tiny::BadASTError);
+}
+
+TEST(AST, WalkDeepTree) {
+    // A right-nested chain, like the ones built for long additions, that is too deep to be walked recursively
+    constexpr std::size_t depth = 1000000;
+
+    tiny::ASTArena arena;
+    auto root = arena.add(tiny::ASTNode(tiny::Metadata(), tiny::ASTNodeType::OpAddition));
+    auto last = root;
+    for (std::size_t i = 1; i<depth; i++) {
+        auto node = arena.add(tiny::ASTNode(tiny::Metadata(), tiny::ASTNodeType::OpAddition));
+        last.addChildren(node);
+        last = node;
+    }
+
+    const auto &constArena = arena;
+    std::size_t entered = 0;
+    std::vector<tiny::NodeId> left;
+    constArena.walk(root.getId(), [&](tiny::NodeId) {
+        entered++;
+        return true;
+    }, [&](tiny::NodeId id) {
+        left.push_back(id);
+    });
+
+    ASSERT_EQ(entered, depth);
+    ASSERT_EQ(left.size(), depth);
+    ASSERT_EQ(left.front(), last.getId());
+    ASSERT_EQ(left.back(), root.getId());
+
+    // Skipped nodes are neither descended into nor left
+    entered = 0;
+    left.clear();
+    constArena.walk(root.getId(), [&](tiny::NodeId id) {
+        entered++;
+        return id == root.getId();
+    }, [&](tiny::NodeId id) {
+        left.push_back(id);
+    });
+
+    ASSERT_EQ(entered, 2);
+    ASSERT_EQ(left, std::vector<tiny::NodeId>{root.getId()});
+}
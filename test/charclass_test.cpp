@@ -0,0 +1,33 @@
+#include "gtest/gtest.h"
+
+#include "charclass.h"
+
+TEST(CharClass, ASCII) {
+    ASSERT_TRUE(tiny::isBlank(' '));
+    ASSERT_TRUE(tiny::isBlank('\t'));
+    ASSERT_FALSE(tiny::isBlank('\n'));
+    ASSERT_FALSE(tiny::isBlank(0x2009)); // THIN SPACE truncates to a tab
+
+    ASSERT_TRUE(tiny::isDigit('7'));
+    ASSERT_FALSE(tiny::isDigit('a'));
+    ASSERT_FALSE(tiny::isDigit(0x0661));
+
+    ASSERT_TRUE(tiny::isHexDigit('F'));
+    ASSERT_TRUE(tiny::isHexDigit('f'));
+    ASSERT_FALSE(tiny::isHexDigit('g'));
+
+    ASSERT_TRUE(tiny::isIdStart('_'));
+    ASSERT_FALSE(tiny::isIdStart('1'));
+    ASSERT_TRUE(tiny::isIdContinue('1'));
+    ASSERT_FALSE(tiny::isIdContinue('-'));
+}
+
+TEST(CharClass, XID) {
+    ASSERT_TRUE(tiny::isIdStart(0x00E9)); // é
+    ASSERT_TRUE(tiny::isIdStart(0x65E5)); // 日
+    ASSERT_FALSE(tiny::isIdStart(0x0661)); // ARABIC-INDIC DIGIT ONE
+    ASSERT_TRUE(tiny::isIdContinue(0x0661));
+    ASSERT_FALSE(tiny::isIdStart(0x20AC)); // €
+    ASSERT_FALSE(tiny::isIdContinue(0xFFFD));
+    ASSERT_FALSE(tiny::isIdContinue(0x10FFFF));
+}
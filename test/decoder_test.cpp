@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+
+#include "decoder.h"
+#include "errors.h"
+#include "unicode.h"
+
+static std::vector<tiny::SIMDLevel> supportedLevels() {
+    std::vector<tiny::SIMDLevel> levels = {tiny::SIMDLevel::Scalar};
+    if (tiny::getSIMDLevel() >= tiny::SIMDLevel::SSE2) {
+        levels.push_back(tiny::SIMDLevel::SSE2);
+    }
+
+    if (tiny::getSIMDLevel() >= tiny::SIMDLevel::AVX2) {
+        levels.push_back(tiny::SIMDLevel::AVX2);
+    }
+
+    return levels;
+}
+
+TEST(Decoder, ASCII) {
+    std::string str;
+    for (int i = 0; i < 100; i++) {
+        str += static_cast<char>('!' + i % 90);
+    }
+
+    for (auto level: supportedLevels()) {
+        std::vector<std::uint32_t> out;
+        ASSERT_EQ(tiny::decodeUTF8(str, out, level), str.size());
+        ASSERT_EQ(out, std::vector<std::uint32_t>(str.begin(), str.end()));
+    }
+}
+
+TEST(Decoder, MultiByte) {
+    // Multi-byte sequences both inside and after the vectorized blocks
+    std::string str = "func main() { return \"áé€😀\" + 1234567890 }   ñ";
+    std::vector<std::uint32_t> expected = {'f', 'u', 'n', 'c', ' ', 'm', 'a', 'i', 'n', '(', ')', ' ', '{', ' ', 'r',
+                                           'e', 't', 'u', 'r', 'n', ' ', '"', 0xe1, 0xe9, 0x20ac, 0x1f600, '"', ' ',
+                                           '+', ' ', '1', '2', '3', '4', '5', '6', '7', '8', '9', '0', ' ', '}', ' ',
+                                           ' ', ' ', 0xf1};
+
+    for (auto level: supportedLevels()) {
+        std::vector<std::uint32_t> out;
+        ASSERT_EQ(tiny::decodeUTF8(str, out, level), str.size());
+        ASSERT_EQ(out, expected);
+    }
+}
+
+TEST(Decoder, StopAtNull) {
+    std::string str = "0123456789abcdefghijklmnopqrstuvwxyz";
+    str[20] = '\0';
+
+    for (auto level: supportedLevels()) {
+        std::vector<std::uint32_t> out;
+        ASSERT_EQ(tiny::decodeUTF8(str, out, level), 20);
+        ASSERT_EQ(out.size(), 20);
+    }
+}
+
+TEST(Decoder, InvalidOffset) {
+    std::string invalid = std::string(40, 'a') + "\xff" + "b";
+    std::string truncated = std::string(40, 'a') + "\xe2\x82";
+    std::string overlong = std::string(3, 'a') + "\xc0\xaf" + std::string(40, 'a');
+
+    for (auto level: supportedLevels()) {
+        std::vector<std::uint32_t> out;
+
+        try {
+            tiny::decodeUTF8(invalid, out, level);
+            FAIL() << "Expected DecodeError";
+        } catch (const tiny::DecodeError &e) {
+            ASSERT_EQ(e.offset, 40);
+        }
+
+        try {
+            tiny::decodeUTF8(truncated, out, level);
+            FAIL() << "Expected DecodeError";
+        } catch (const tiny::DecodeError &e) {
+            ASSERT_EQ(e.offset, 40);
+        }
+
+        try {
+            tiny::decodeUTF8(overlong, out, level);
+            FAIL() << "Expected DecodeError";
+        } catch (const tiny::DecodeError &e) {
+            ASSERT_EQ(e.offset, 3);
+        }
+
+        ASSERT_TRUE(out.empty());
+    }
+}
+
+TEST(Decoder, String) {
+    ASSERT_EQ(tiny::String("añ€").data(), std::vector<std::uint32_t>({'a', 0xf1, 0x20ac}));
+    ASSERT_THROW(tiny::String("a\xff"), tiny::DecodeError);
+
+    // Offsets are relative to the whole input, not to the part after the ASCII prefix
+    try {
+        tiny::String(std::string(40, 'a') + "ñ\xff");
+        FAIL() << "Expected DecodeError";
+    } catch (const tiny::DecodeError &e) {
+        ASSERT_EQ(e.offset, 42);
+        ASSERT_EQ(std::string(e.what()), "Invalid UTF-8 lead byte at byte 42");
+    }
+}
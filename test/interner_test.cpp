@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+
+#include <thread>
+
+#include "interner.h"
+#include "errors.h"
+
+TEST(Interner, Empty) {
+    ASSERT_EQ(tiny::Symbol().getId(), 0);
+    ASSERT_EQ(tiny::Symbol(""), tiny::Symbol());
+    ASSERT_TRUE(tiny::Symbol("").empty());
+}
+
+TEST(Interner, SameString) {
+    tiny::Symbol a("identifier");
+    tiny::Symbol b(tiny::String("identifier"));
+    tiny::Symbol c(std::string_view("identifier2").substr(0, 10));
+
+    ASSERT_EQ(a, b);
+    ASSERT_EQ(a, c);
+    ASSERT_NE(a, tiny::Symbol("identifier2"));
+
+    ASSERT_EQ(a.view(), "identifier");
+    ASSERT_EQ(a.str(), tiny::String("identifier"));
+    ASSERT_EQ(tiny::Symbol::fromId(a.getId()), a);
+}
+
+TEST(Interner, Unicode) {
+    tiny::Symbol sym("añ€");
+
+    ASSERT_EQ(sym.toString(), "añ€");
+    ASSERT_EQ(sym.str().size(), 3);
+    ASSERT_THROW(tiny::Symbol(std::string_view("a\xff")), tiny::DecodeError);
+}
+
+TEST(Interner, Concurrent) {
+    // Enough distinct strings to span several storage chunks
+    constexpr int count = 5000;
+
+    std::vector<std::vector<tiny::Symbol>> results(4);
+    std::vector<std::thread> threads;
+    for (auto &result: results) {
+        threads.emplace_back([&result]() {
+            for (int i = 0; i < count; i++) {
+                result.emplace_back(std::string_view("concurrent" + std::to_string(i)));
+            }
+        });
+    }
+
+    for (auto &t: threads) {
+        t.join();
+    }
+
+    for (int i = 0; i < count; i++) {
+        for (auto &result: results) {
+            ASSERT_EQ(result[i], results[0][i]);
+        }
+
+        ASSERT_EQ(results[0][i].view(), "concurrent" + std::to_string(i));
+    }
+}
@@ -0,0 +1,82 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "jsonwriter.h"
+#include "lexer.h"
+#include "parser.h"
+
+TEST(JSONWriter, MatchesNlohmann) {
+    nlohmann::json expected{
+            {"empty", nlohmann::json::object()},
+            {"list", {1, true, "a\"b\\c\n\t\x01"}},
+            {"none", nlohmann::json::array()},
+            {"text", "ñandú"},
+    };
+
+    for (auto layout: {tiny::JSONLayout::Pretty, tiny::JSONLayout::Compact}) {
+        std::ostringstream out;
+        {
+            tiny::JSONWriter writer(out, layout);
+            writer.beginObject();
+            writer.key("empty");
+            writer.beginObject();
+            writer.endObject();
+            writer.key("list");
+            writer.beginArray();
+            writer.value(std::uint64_t(1));
+            writer.value(true);
+            writer.value("a\"b\\c\n\t\x01");
+            writer.endArray();
+            writer.key("none");
+            writer.beginArray();
+            writer.endArray();
+            writer.key("text");
+            writer.value("ñandú");
+            writer.endObject();
+        }
+
+        ASSERT_EQ(out.str(), layout == tiny::JSONLayout::Pretty ? expected.dump(4) : expected.dump());
+    }
+}
+
+TEST(JSONWriter, ASTFile) {
+    auto src = std::make_shared<const tiny::Source>(std::string(
+            "module test\nimport (io, math as m)\nfunc f(int a) (int) {\n    return a * 2\n}\nx := f(1) + \"y\"\n"));
+    tiny::Lexer lexer{tiny::SourceStream(src)};
+    tiny::Parser parser(lexer);
+    auto file = parser.file(tiny::File());
+
+    std::ostringstream pretty;
+    {
+        tiny::JSONWriter writer(pretty);
+        file.writeJson(writer);
+    }
+
+    ASSERT_EQ(pretty.str(), file.toJson().dump(4));
+
+    std::ostringstream lines;
+    {
+        tiny::JSONWriter writer(lines, tiny::JSONLayout::Compact);
+        file.writeJsonLines(writer);
+    }
+
+    // A header with the file's fields, then a line per statement
+    auto expected = file.toJson();
+    auto statements = expected["file"]["statements"];
+    expected["file"].erase("statements");
+
+    std::istringstream in(lines.str());
+    std::string line;
+    std::getline(in, line);
+    ASSERT_EQ(line, expected.dump());
+
+    for (auto &s: statements) {
+        std::getline(in, line);
+        ASSERT_EQ(line, s.dump());
+    }
+
+    ASSERT_FALSE(std::getline(in, line));
+}
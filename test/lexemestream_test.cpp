@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include "lexemestream.h"
+#include "errors.h"
+
+TEST(LexemeStream, StreamOperations) {
+    std::stringstream data;
+    data << "a b c";
+
+    tiny::Lexer lexer(data);
+    tiny::LexemeStream ls(lexer);
+
+    ASSERT_TRUE(ls.isTerminator(ls.last()));
+    ASSERT_EQ(ls.get().value, "a");
+    ASSERT_EQ(ls.peek().value, "b");
+    ASSERT_EQ(ls.peek(1).value, "c");
+    ASSERT_EQ(ls.last().value, "a");
+
+    ls.skip();
+    ls.backup();
+    ASSERT_EQ(ls.get().value, "b");
+    ASSERT_EQ(ls.get().value, "c");
+
+    ASSERT_TRUE(ls.isTerminator(ls.get()));
+    ASSERT_TRUE(ls.isTerminator(ls.peek()));
+    ASSERT_EQ(ls.getIndex(), 3);
+
+    ls.backup();
+    ASSERT_EQ(ls.peek().value, "c");
+}
+
+TEST(LexemeStream, Lazy) {
+    std::stringstream data;
+    data << "a b @";
+
+    tiny::Lexer lexer(data);
+    tiny::LexemeStream ls(lexer);
+
+    // The invalid symbol is only lexed once it's reached
+    ASSERT_EQ(ls.get().value, "a");
+    ASSERT_TRUE(bool(lexer));
+    ASSERT_THROW((void) ls.peek(1), tiny::LexError);
+}
+
+TEST(LexemeStream, BoundedBuffer) {
+    std::stringstream data;
+    for (int i = 0; i < 1000; i++) {
+        data << "id" << i << " ";
+    }
+    data << "end";
+
+    tiny::Lexer lexer(data);
+    tiny::LexemeStream ls(lexer);
+
+    while (!ls.isTerminator(ls.get())) {
+        ASSERT_LE(ls.buffered(), 16);
+    }
+}
+
+TEST(LexemeStream, Checkpoints) {
+    std::stringstream data;
+    for (int i = 0; i < 1000; i++) {
+        data << "id" << i << " ";
+    }
+    data << "end";
+
+    tiny::Lexer lexer(data);
+    tiny::LexemeStream ls(lexer);
+
+    ASSERT_EQ(ls.get().value, "id0");
+
+    {
+        auto checkpoint = ls.checkpoint();
+        while (!ls.isTerminator(ls.get()));
+
+        // Everything since the checkpoint is kept, plus the Lexeme before it
+        ASSERT_EQ(ls.buffered(), 1001);
+
+        ls.seek(checkpoint);
+        ASSERT_EQ(ls.last().value, "id0");
+        ASSERT_EQ(ls.get().value, "id1");
+    }
+
+    // Releasing the checkpoint doesn't drop what the cursor can still reach
+    for (int i = 0; i < 100; i++) {
+        ls.skip();
+    }
+    ASSERT_EQ(ls.get().value, "id102");
+}
+
+TEST(LexemeStream, FromTokenBuffer) {
+    std::stringstream data;
+    data << "a b c d e f g h i j k l m n o p q r";
+
+    tiny::Lexer lexer(data);
+    tiny::LexemeStream ls(lexer.tokenize());
+
+    std::string got;
+    while (ls) {
+        got += ls.get().value;
+    }
+
+    ASSERT_EQ(got, "abcdefghijklmnopqr");
+    ASSERT_EQ(ls.get(), tiny::Token::None);
+    ASSERT_EQ(ls.last().value, "r");
+}
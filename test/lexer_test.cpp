@@ -9,6 +9,7 @@
 
 #include "stream.h"
 #include "lexer.h"
+#include "tokenbuffer.h"
 #include "errors.h"
 
 // Some helper functions for the benchmark
@@ -16,8 +17,8 @@
 std::random_device rd;
 std::mt19937 randomGen(rd());
 
-tiny::String idRandChars =
-        "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyzáÁäÄçÇúÚüÜéÉëËóÓöÖíÍïÏ_";
+std::vector<std::uint32_t> idRandChars = tiny::String(
+        "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyzáÁäÄçÇúÚüÜéÉëËóÓöÖíÍïÏ_").data();
 std::map<tiny::String, tiny::Lexeme> tokenRand{
         {"func",          tiny::Lexeme(tiny::Token::KwFunc)},
         {"as",            tiny::Lexeme(tiny::Token::KwAs)},
@@ -47,9 +48,9 @@ tiny::Lexeme randomId() {
     tiny::String id;
     do {
         id = "";
-        std::shuffle(idRandChars.codepoints.begin(), idRandChars.codepoints.end(), randomGen);
+        std::shuffle(idRandChars.begin(), idRandChars.end(), randomGen);
 
-        std::uniform_int_distribution uni(1, std::int32_t(idRandChars.codepoints.size() - 1));
+        std::uniform_int_distribution uni(1, std::int32_t(idRandChars.size() - 1));
 
 
         for (std::int32_t size = uni(randomGen); size > 0; size--) {
@@ -65,7 +66,7 @@ std::pair<tiny::String, tiny::Lexeme> randomLexeme() {
     std::uniform_int_distribution<std::int32_t> zeroToOne(0, 1);
     if (zeroToOne(randomGen) < .333) { // 1/3 chance
         auto id = randomId();
-        return {id.value, id};
+        return {id.getString(), id};
     }
 
     std::uniform_int_distribution<std::int32_t> randomTokenRand(1, tokenRand.size() - 1);
@@ -76,8 +77,34 @@ std::pair<tiny::String, tiny::Lexeme> randomLexeme() {
     return {item->first, item->second};
 }
 
-TEST(Lexer, LocaleSetup) {
-    std::locale::global(std::locale("en_US.UTF8"));
+TEST(Lexer, LocaleIndependent) {
+    // Classification doesn't depend on the global locale, even for non-ASCII identifiers
+    std::locale::global(std::locale::classic());
+
+    std::stringstream data;
+    data << "máïn ñ_1 日本 x\u0661 _ \u0130";
+
+    tiny::Lexer lexer(data);
+
+    auto lexemes = lexer.lexAll();
+    ASSERT_EQ(lexemes.size(), 6);
+
+    for (auto const &l: lexemes) {
+        ASSERT_EQ(l.token, tiny::Token::Id);
+    }
+
+    ASSERT_EQ(lexemes[3].value, "x\u0661"); // ARABIC-INDIC DIGIT ONE continues an identifier
+}
+
+TEST(Lexer, NonIdentifierCodepoints) {
+    // PER MILLE SIGN (U+2030) isn't part of identifiers, even if its low byte is the digit zero
+    std::stringstream data;
+    data << "a\u2030";
+
+    tiny::Lexer lexer(data);
+
+    ASSERT_EQ(lexer.lex().value, "a");
+    ASSERT_THROW((void) lexer.lex(), tiny::LexError);
 }
 
 TEST(Lexer, NewLine) {
@@ -129,6 +156,20 @@ TEST(Lexer, Keywords) {
     }
 }
 
+TEST(Lexer, KeywordLookalikes) {
+    std::stringstream data;
+    data << "i inn int8 uint128 Const functional float16 trueish";
+
+    tiny::Lexer lexer(data);
+
+    auto lexemes = lexer.lexAll();
+    ASSERT_EQ(lexemes.size(), 8);
+
+    for (auto const &l: lexemes) {
+        ASSERT_EQ(l.token, tiny::Token::Id);
+    }
+}
+
 TEST(Lexer, Ints) {
     std::stringstream data;
     data << "int int16 int32 int64 uint uint16 uint32 uint64";
@@ -314,6 +355,42 @@ TEST(Lexer, NumLiterals) {
     ASSERT_EQ(lexemes, expect);
 }
 
+TEST(Lexer, NumValues) {
+    std::stringstream data;
+    data << "0 42 0xFF 0x 1.5 0. 9223372036854775807 9223372036854775808 18446744073709551615 0xFFFFFFFFFFFFFFFF";
+
+    tiny::Lexer lexer(data);
+
+    auto lexemes = lexer.lexAll();
+    std::vector<tiny::Number> expect{
+            std::int64_t(0),
+            std::int64_t(42),
+            std::int64_t(255),
+            std::int64_t(0),
+            1.5L,
+            0.0L,
+            std::int64_t(9223372036854775807),
+            std::uint64_t(9223372036854775808u),
+            std::uint64_t(18446744073709551615u),
+            std::uint64_t(18446744073709551615u),
+    };
+
+    ASSERT_EQ(lexemes.size(), expect.size());
+    for (std::size_t i = 0; i < expect.size(); i++) {
+        ASSERT_EQ(lexemes[i].number, expect[i]) << lexemes[i].value;
+    }
+}
+
+TEST(Lexer, NumOutOfRange) {
+    for (auto literal: {"18446744073709551616", "0x10000000000000000"}) {
+        std::stringstream data;
+        data << literal << " ";
+
+        tiny::Lexer lexer(data);
+        ASSERT_THROW((void) lexer.lex(), tiny::LexError) << literal;
+    }
+}
+
 TEST(Lexer, StrLiterals) {
     std::stringstream data;
     data << "\"hi\"  \"bye\" \"foo\" \"bar\" \"hí\" \"ó!alw'q_./return     1  2\"";
@@ -387,9 +464,44 @@ TEST(Lexer, MultilineComment) {
     ASSERT_EQ(lexemes, expect);
 }
 
-TEST(Lexer, Unicode) {
-    std::locale::global(std::locale("en_US.UTF8"));
+TEST(Lexer, TriviaModes) {
+    const std::string source = "// one\nvar1 /* two */ := 0 // three";
 
+    std::vector<tiny::Lexeme> code{
+            tiny::Lexeme(tiny::Token::NewLine),
+            tiny::Lexeme(tiny::Token::Id, "var1"),
+            tiny::Lexeme(tiny::Token::Init),
+            tiny::Lexeme(tiny::Token::LiteralNum, "0"),
+    };
+
+    std::vector<tiny::Lexeme> comments{
+            tiny::Lexeme(tiny::Token::SinglelineComment, " one"),
+            tiny::Lexeme(tiny::Token::MultilineComment, " two "),
+            tiny::Lexeme(tiny::Token::SinglelineComment, " three"),
+    };
+
+    std::stringstream skipData(source);
+    tiny::Lexer skipping(skipData);
+    skipping.setTriviaMode(tiny::TriviaMode::Skip);
+
+    ASSERT_EQ(skipping.lexAll(), code);
+    ASSERT_TRUE(skipping.getTrivia().empty());
+
+    std::stringstream collectData(source);
+    tiny::Lexer collecting(collectData);
+    collecting.setTriviaMode(tiny::TriviaMode::Collect);
+
+    ASSERT_EQ(collecting.lexAll(), code);
+    ASSERT_EQ(collecting.getTrivia(), comments);
+
+    // Unclosed comments are still errors, even if they'd be skipped
+    std::stringstream unclosed("/* never closed");
+    tiny::Lexer lexer(unclosed);
+    lexer.setTriviaMode(tiny::TriviaMode::Skip);
+    ASSERT_THROW((void) lexer.lexAll(), tiny::LexError);
+}
+
+TEST(Lexer, Unicode) {
     std::stringstream data;
     data << "func máïn(){\n//úñícÖdé\n}";
 
@@ -699,8 +811,199 @@ TEST(Lexer, TestProgram3) {
     ASSERT_EQ(lexemes, expect);
 }
 
+TEST(Lexer, ValuesViewSource) {
+    auto src = std::make_shared<const tiny::Source>(std::string("foo \"a long string literal\" // comment"));
+    tiny::Lexer lexer{tiny::SourceStream(src)};
+
+    auto lexemes = lexer.lexAll();
+    ASSERT_EQ(lexemes.size(), 3);
+
+    for (auto const &l: lexemes) {
+        // Values aren't copied out of the source
+        ASSERT_GE(l.value.data(), src->data());
+        ASSERT_LE(l.value.data() + l.value.size(), src->data() + src->size());
+    }
+
+    ASSERT_EQ(lexemes[1].value, "a long string literal");
+    ASSERT_EQ(lexemes[2].getSymbol(), tiny::Symbol(" comment"));
+}
+
+TEST(Lexer, ParallelSameAsSequential) {
+    // Strings and comments long enough for many chunks to start inside of them, some holding symbols that can't be
+    // lexed on their own
+    std::string text;
+    for (int i = 0; i < 50; i++) {
+        text += "var" + std::to_string(i) + " := \"a string @ with # symbols\" + 0x1F // comment " +
+                std::to_string(i) + "\n";
+        text += "/* a\nmultiline @\ncomment \"with a quote\n*/ f(1.5, 'c')\n";
+    }
+
+    auto src = std::make_shared<const tiny::Source>(text);
+    for (auto mode: {tiny::TriviaMode::Emit, tiny::TriviaMode::Skip, tiny::TriviaMode::Collect}) {
+        tiny::Lexer sequential{tiny::SourceStream(src)};
+        sequential.setTriviaMode(mode);
+        auto expect = sequential.tokenize();
+
+        for (std::size_t minChunk: {1, 7, 64, 1000}) {
+            tiny::Lexer parallel{tiny::SourceStream(src)};
+            parallel.setTriviaMode(mode);
+            auto got = parallel.tokenizeParallel(8, minChunk);
+
+            ASSERT_FALSE(parallel);
+            ASSERT_EQ(got.size(), expect.size()) << minChunk;
+            for (std::size_t i = 0; i < got.size(); i++) {
+                ASSERT_EQ(got[i], expect[i]) << minChunk << " " << i;
+                ASSERT_EQ(got[i].start, expect[i].start) << minChunk << " " << i;
+                ASSERT_EQ(got[i].end, expect[i].end) << minChunk << " " << i;
+            }
+
+            ASSERT_EQ(parallel.getTrivia(), sequential.getTrivia());
+        }
+    }
+}
+
+TEST(Lexer, ParallelErrors) {
+    std::string text;
+    for (int i = 0; i < 100; i++) {
+        text += "a := \"@\" // @\n";
+    }
+
+    // An error that happens sequentially is thrown, even if chunks started after it lexed fine
+    auto src = std::make_shared<const tiny::Source>(text + "@\n" + text);
+    tiny::Lexer lexer{tiny::SourceStream(src)};
+
+    try {
+        (void) lexer.tokenizeParallel(8, 16);
+        FAIL() << "No LexError thrown";
+    } catch (const tiny::LexError &e) {
+        ASSERT_EQ(e.meta.start, text.size());
+    }
+}
+
+TEST(Lexer, Relex) {
+    std::string text;
+    for (int i = 0; i < 10; i++) {
+        text += "var" + std::to_string(i) + " := \"a string\" + 0x1F // comment\n";
+        text += "/* a\nmultiline\ncomment */ f(1.5, 'c')\n";
+    }
+
+    ASSERT_EQ((tiny::TextEdit{1, 2, "xyz"}.apply("abcd")), "axyzd");
+
+    // Edits that open or close strings and comments, and split or join tokens
+    const std::string pieces[] = {"", "x", "12", " ", "\n", "\"", "//", "/*", "*/", ".", "=", "'c'"};
+
+    std::mt19937 random(7);
+    for (auto mode: {tiny::TriviaMode::Emit, tiny::TriviaMode::Skip}) {
+        auto before = std::make_shared<const tiny::Source>(text);
+        tiny::Lexer lexer{tiny::SourceStream(before)};
+        lexer.setTriviaMode(mode);
+        auto tokens = lexer.tokenize();
+
+        for (int i = 0; i < 500; i++) {
+            auto offset = random() % (before->size() + 1);
+            tiny::TextEdit edit{offset, (std::min)(std::uint64_t(random() % 4), before->size() - offset),
+                                pieces[random() % std::size(pieces)]};
+
+            auto after = std::make_shared<const tiny::Source>(edit.apply(before->view()));
+
+            tiny::Lexer sequential{tiny::SourceStream(after)};
+            sequential.setTriviaMode(mode);
+
+            tiny::TokenBuffer expect;
+            try {
+                expect = sequential.tokenize();
+            } catch (const tiny::LexError &) {
+                // The edit broke the source. Keep the tokens from before it
+                continue;
+            }
+
+            tiny::Lexer incremental{tiny::SourceStream(after)};
+            incremental.setTriviaMode(mode);
+            auto got = incremental.relex(tokens, edit);
+
+            ASSERT_FALSE(incremental);
+            ASSERT_EQ(got.size(), expect.size()) << i;
+            for (std::size_t j = 0; j < got.size(); j++) {
+                ASSERT_EQ(got[j], expect[j]) << i << " " << j;
+                ASSERT_EQ(got[j].start, expect[j].start) << i << " " << j;
+                ASSERT_EQ(got[j].end, expect[j].end) << i << " " << j;
+                ASSERT_EQ(got[j].number, expect[j].number) << i << " " << j;
+            }
+
+            before = after;
+            tokens = std::move(got);
+        }
+    }
+}
+
+TEST(Lexer, RecoverErrors) {
+    std::stringstream data;
+    data << "a @ b\n"
+            "x := \"unterminated\n"
+            "y := 00x12 + 1.2.3\n"
+            "z := 'ab' + c\n"
+            "/* unclosed";
+
+    tiny::Lexer lexer(data);
+    lexer.setErrorMode(tiny::ErrorMode::Recover);
+    auto lexemes = lexer.lexAll();
+
+    std::vector<tiny::Lexeme> expect{
+            tiny::Lexeme(tiny::Token::Id, tiny::Symbol("a")),
+            tiny::Lexeme(tiny::Token::Id, tiny::Symbol("b")),
+            tiny::Lexeme(tiny::Token::NewLine),
+            tiny::Lexeme(tiny::Token::Id, tiny::Symbol("x")),
+            tiny::Lexeme(tiny::Token::Init),
+            tiny::Lexeme(tiny::Token::NewLine),
+            tiny::Lexeme(tiny::Token::Id, tiny::Symbol("y")),
+            tiny::Lexeme(tiny::Token::Init),
+            tiny::Lexeme(tiny::Token::Sum),
+            tiny::Lexeme(tiny::Token::NewLine),
+            tiny::Lexeme(tiny::Token::Id, tiny::Symbol("z")),
+            tiny::Lexeme(tiny::Token::Init),
+            tiny::Lexeme(tiny::Token::NewLine),
+    };
+
+    ASSERT_EQ(lexemes, expect);
+
+    std::vector<std::uint64_t> starts;
+    for (auto const &e: lexer.getDiagnostics()) {
+        starts.push_back(e.meta.start);
+    }
+
+    ASSERT_EQ(starts, (std::vector<std::uint64_t>{2, 11, 30, 38, 49, 69}));
+}
+
+TEST(Lexer, ParallelRecoverErrors) {
+    std::string text;
+    for (int i = 0; i < 100; i++) {
+        text += "a := \"@\" @ // @\n";
+        text += i % 7 ? "b := 1.2.3\n" : "c := \"unterminated\n";
+    }
+
+    auto src = std::make_shared<const tiny::Source>(text);
+
+    tiny::Lexer sequential{tiny::SourceStream(src)};
+    sequential.setErrorMode(tiny::ErrorMode::Recover);
+    auto expect = sequential.tokenize();
+
+    tiny::Lexer parallel{tiny::SourceStream(src)};
+    parallel.setErrorMode(tiny::ErrorMode::Recover);
+    auto got = parallel.tokenizeParallel(8, 16);
+
+    ASSERT_EQ(got.size(), expect.size());
+    for (std::size_t i = 0; i < got.size(); i++) {
+        ASSERT_EQ(got[i], expect[i]) << i;
+        ASSERT_EQ(got[i].start, expect[i].start) << i;
+    }
+
+    ASSERT_EQ(parallel.getDiagnostics().size(), sequential.getDiagnostics().size());
+    for (std::size_t i = 0; i < parallel.getDiagnostics().size(); i++) {
+        ASSERT_EQ(parallel.getDiagnostics()[i].meta.start, sequential.getDiagnostics()[i].meta.start) << i;
+    }
+}
+
 TEST(Lexer, Benchmark) {
-    std::locale::global(std::locale("en_US.UTF8"));
     const std::int32_t benchmarkSize = 10000;
 
     // Generate the lexemes now, so they don't slow down the lexer when benchmarking
@@ -736,3 +1039,17 @@ TEST(Lexer, Benchmark) {
 
     ASSERT_EQ(lexemes, expect);
 }
+
+TEST(Lexer, TokenSet) {
+    constexpr tiny::TokenSet set{tiny::Token::None, tiny::Token::NewLine, tiny::Token::MultilineComment};
+    static_assert(set.contains(tiny::Token::MultilineComment));
+
+    ASSERT_TRUE(set.contains(tiny::Token::None));
+    ASSERT_TRUE(set.contains(tiny::Token::NewLine));
+    ASSERT_FALSE(set.contains(tiny::Token::Id));
+    ASSERT_FALSE(set.contains(tiny::Token::SinglelineComment));
+
+    auto copy = set;
+    ASSERT_TRUE(copy.add(tiny::Token::Id).contains(tiny::Token::Id));
+    ASSERT_FALSE(tiny::TokenSet().contains(tiny::Token::None));
+}
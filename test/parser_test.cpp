@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <string>
+
+#include "lexer.h"
+#include "parser.h"
+#include "errors.h"
+
+// Describes the types of a node and its descendants, like "OpAddition(LiteralInt, LiteralInt)"
+static std::string shape(tiny::ConstNodeRef node) {
+    auto str = node->toString();
+    if (node.children().empty()) {
+        return str;
+    }
+
+    auto separator = "(";
+    for (auto c: node.children()) {
+        str += separator + shape(c);
+        separator = ", ";
+    }
+
+    return str + ")";
+}
+
+// Parses a single expression statement inside a file
+static std::string parseExpression(const std::string &code) {
+    auto src = std::make_shared<const tiny::Source>("module test\n" + code + "\n");
+    tiny::Lexer lexer{tiny::SourceStream(src)};
+    tiny::Parser parser(lexer);
+
+    auto file = parser.file(tiny::File());
+    return shape(file.nodes.get(file.statements.at(0)).getFirstChild());
+}
+
+TEST(Parser, Precedence) {
+    ASSERT_EQ(parseExpression("1 + 2 * 3 ** 4"),
+              "OpAddition(LiteralInt, OpMultiplication(LiteralInt, OpExponentiate(LiteralInt, LiteralInt)))");
+    ASSERT_EQ(parseExpression("a < b == c and d"),
+              "LogicalAnd(CompareEq(CompareLt(Identifier, Identifier), Identifier), Identifier)");
+    ASSERT_EQ(parseExpression("-a ** 2"), "OpExponentiate(UnaryNegative(Identifier), LiteralInt)");
+    ASSERT_EQ(parseExpression("(1 + 2) * 3"), "OpMultiplication(OpAddition(LiteralInt, LiteralInt), LiteralInt)");
+    ASSERT_EQ(parseExpression("x := 1 + 2"), "Initialization(Identifier, OpAddition(LiteralInt, LiteralInt))");
+}
+
+TEST(Parser, Associativity) {
+    // Additions and subtractions nest to the right, the rest of the operators to the left
+    ASSERT_EQ(parseExpression("1 - 2 + 3"), "OpSubtraction(LiteralInt, OpAddition(LiteralInt, LiteralInt))");
+    ASSERT_EQ(parseExpression("1 / 2 * 3"), "OpMultiplication(OpDivision(LiteralInt, LiteralInt), LiteralInt)");
+    ASSERT_EQ(parseExpression("2 ** 3 ** 4"), "OpExponentiate(OpExponentiate(LiteralInt, LiteralInt), LiteralInt)");
+    ASSERT_EQ(parseExpression("a or b and c"), "LogicalAnd(LogicalOr(Identifier, Identifier), Identifier)");
+}
+
+TEST(Parser, Postfix) {
+    ASSERT_EQ(parseExpression("a.b[c](d)"),
+              "FunctionCall(IndexedAccess(MemberAccess(Identifier, Identifier), Identifier), "
+              "FunctionCallArgumentList(Identifier))");
+    ASSERT_EQ(parseExpression("f()()"), "FunctionCall(FunctionCall(Identifier, FunctionCallArgumentList), "
+                                        "FunctionCallArgumentList)");
+
+    // Member accesses can't follow a call
+    ASSERT_THROW(parseExpression("f().a"), tiny::ParseError);
+}
+
+TEST(Parser, ForConditions) {
+    ASSERT_EQ(parseExpression("for i := 0..10 {}"), "BranchCondition(RangeExpression(RangeFromExpression(LiteralInt), "
+                                                    "RangeToExpression(LiteralInt), RangeStepExpression))");
+    ASSERT_EQ(parseExpression("for i in items {}"), "BranchCondition(ForEachExpression(Identifier))");
+    ASSERT_EQ(parseExpression("for i := 0 {}"), "BranchCondition(Initialization(Identifier, LiteralInt))");
+    ASSERT_EQ(parseExpression("for i < 10 {}"), "BranchCondition(CompareLt(Identifier, LiteralInt))");
+}
+
+TEST(Parser, TypedExpressions) {
+    ASSERT_EQ(parseExpression("int x := 1"), "Initialization(TypedExpression(Type), LiteralInt)");
+    ASSERT_EQ(parseExpression("const *Point p := q"), "Initialization(TypedExpression(Type), Identifier)");
+    ASSERT_EQ(parseExpression("$Point p := q"), "Initialization(TypedExpression(Type), Identifier)");
+    ASSERT_EQ(parseExpression("p := q"), "Initialization(Identifier, Identifier)");
+}
@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+
+#include <random>
+
+#include "scan.h"
+
+static std::vector<tiny::SIMDLevel> supportedLevels() {
+    std::vector<tiny::SIMDLevel> levels = {tiny::SIMDLevel::Scalar};
+    if (tiny::getSIMDLevel() >= tiny::SIMDLevel::SSE2) {
+        levels.push_back(tiny::SIMDLevel::SSE2);
+    }
+
+    if (tiny::getSIMDLevel() >= tiny::SIMDLevel::AVX2) {
+        levels.push_back(tiny::SIMDLevel::AVX2);
+    }
+
+    return levels;
+}
+
+TEST(Scan, Functions) {
+    // Matches both inside and after the vectorized blocks
+    std::string longer(40, 'x');
+
+    ASSERT_EQ(tiny::findNewline("abc\ndef"), 3);
+    ASSERT_EQ(tiny::findNewline(longer + "\n"), 40);
+    ASSERT_EQ(tiny::findNewline(longer), 40);
+
+    ASSERT_EQ(tiny::findStringEnd("ab\"c"), 2);
+    ASSERT_EQ(tiny::findStringEnd(std::string_view("ab\0c\"", 5)), 2);
+    ASSERT_EQ(tiny::findStringEnd(longer), 40);
+
+    ASSERT_EQ(tiny::findCommentEnd("a * b / c */"), 10);
+    ASSERT_EQ(tiny::findCommentEnd(longer + "**/"), 41);
+    ASSERT_EQ(tiny::findCommentEnd(std::string(31, 'x') + "*/"), 31); // Pair split between blocks
+    ASSERT_EQ(tiny::findCommentEnd(longer + "*"), 41);
+
+    ASSERT_EQ(tiny::countBlanks(" \t\r x"), 4);
+    ASSERT_EQ(tiny::countBlanks(std::string(40, ' ')), 40);
+    ASSERT_EQ(tiny::countBlanks("\n"), 0);
+}
+
+TEST(Scan, LevelsAgree) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> pick(0, 9);
+    const char alphabet[] = {'a', ' ', '\t', '\r', '\n', '"', '*', '/', '\0', '\xc3'};
+
+    for (int round = 0; round < 200; round++) {
+        std::string str;
+        for (int i = 0; i < round; i++) {
+            // Mostly plain bytes, so the matches land anywhere in the blocks
+            str += pick(gen) < 7 ? 'a' : alphabet[pick(gen)];
+        }
+
+        for (auto scan: {tiny::Scan::Newline, tiny::Scan::StringEnd, tiny::Scan::CommentEnd, tiny::Scan::Blanks}) {
+            auto expected = tiny::scan(scan, str, tiny::SIMDLevel::Scalar);
+            for (auto level: supportedLevels()) {
+                ASSERT_EQ(tiny::scan(scan, str, level), expected);
+            }
+        }
+    }
+}
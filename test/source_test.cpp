@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+
+#include <fstream>
+
+#include "source.h"
+#include "errors.h"
+
+static const auto sourceSandboxPath = std::filesystem::current_path() / "sandbox" / "source";
+
+TEST(Source, SandboxSetup) {
+    std::filesystem::create_directory(std::filesystem::current_path() / "sandbox");
+    std::filesystem::create_directory(sourceSandboxPath);
+
+    std::ofstream file(sourceSandboxPath / "mapped.ty", std::ios::binary);
+    file << "func máïn()\n";
+
+    std::ofstream empty(sourceSandboxPath / "empty.ty");
+
+    std::cout << "Source Sandbox path is: " << sourceSandboxPath << std::endl;
+}
+
+TEST(Source, MapFile) {
+    tiny::Source src(sourceSandboxPath / "mapped.ty");
+
+    ASSERT_EQ(src.view(), "func máïn()\n");
+}
+
+TEST(Source, MapEmptyFile) {
+    tiny::Source src(sourceSandboxPath / "empty.ty");
+
+    ASSERT_EQ(src.size(), 0);
+}
+
+TEST(Source, MapMissingFile) {
+    ASSERT_THROW(tiny::Source(sourceSandboxPath / "missing.ty"), tiny::FileError);
+}
+
+TEST(SourceStream, DecodeOnDemand) {
+    auto src = std::make_shared<const tiny::Source>(std::string("aá€😀b"));
+    tiny::SourceStream s(src);
+
+    ASSERT_EQ(s.get(), 'a');
+    ASSERT_EQ(s.peek(), 0xe1);
+    ASSERT_EQ(s.get(), 0xe1);
+    ASSERT_EQ(s.getIndex(), 3); // Byte offset, not codepoint index
+    ASSERT_EQ(s.get(), 0x20ac);
+    ASSERT_EQ(s.get(), 0x1f600);
+    ASSERT_EQ(s.get(), 'b');
+    ASSERT_FALSE(s);
+    ASSERT_EQ(s.get(), 0);
+}
+
+TEST(SourceStream, Backup) {
+    auto src = std::make_shared<const tiny::Source>(std::string("a€b"));
+    tiny::SourceStream s(src);
+
+    s.advance(2);
+    ASSERT_EQ(s.peek(), 'b');
+
+    s.backup();
+    ASSERT_EQ(s.peek(), 0x20ac);
+
+    s.backup();
+    s.backup();
+    ASSERT_EQ(s.peek(), 'a');
+}
+
+TEST(SourceStream, InvalidSequence) {
+    auto src = std::make_shared<const tiny::Source>(std::string("a\xff" "b\xe2\x82"));
+    tiny::SourceStream s(src);
+
+    ASSERT_EQ(s.get(), 'a');
+    ASSERT_EQ(s.get(), 0xfffd);
+    ASSERT_EQ(s.get(), 'b');
+    ASSERT_EQ(s.get(), 0xfffd); // Truncated sequence
+}
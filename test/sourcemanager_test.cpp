@@ -0,0 +1,43 @@
+#include "gtest/gtest.h"
+
+#include "sourcemanager.h"
+#include "metadata.h"
+
+TEST(SourceManager, Files) {
+    auto &sm = tiny::SourceManager::get();
+
+    ASSERT_TRUE(sm.getFile(0).path.empty());
+    ASSERT_EQ(sm.getSource(0)->size(), 0);
+
+    auto src = std::make_shared<const tiny::Source>(std::string("abc"));
+    auto id = sm.add(tiny::File{tiny::FileType::Source, "a.ty"}, src);
+
+    ASSERT_NE(id, 0);
+    ASSERT_EQ(sm.getFile(id).path, "a.ty");
+    ASSERT_EQ(sm.getSource(id), src);
+    ASSERT_THROW((void) sm.getFile(id + 1000), std::out_of_range);
+}
+
+TEST(SourceManager, Positions) {
+    auto &sm = tiny::SourceManager::get();
+    auto id = sm.add(tiny::File{}, std::make_shared<const tiny::Source>(std::string("ab\nñé x\n\nz")));
+
+    using Pos = std::pair<std::uint64_t, std::uint64_t>;
+    ASSERT_EQ(sm.getPosition(id, 0), Pos(1, 1));
+    ASSERT_EQ(sm.getPosition(id, 2), Pos(1, 3)); // The newline itself
+    ASSERT_EQ(sm.getPosition(id, 3), Pos(2, 1));
+    ASSERT_EQ(sm.getPosition(id, 8), Pos(2, 4)); // Columns count codepoints, not bytes
+    ASSERT_EQ(sm.getPosition(id, 10), Pos(3, 1));
+    ASSERT_EQ(sm.getPosition(id, 11), Pos(4, 1));
+    ASSERT_EQ(sm.getPosition(id, 100), Pos(4, 2)); // Past the end stops at the end
+}
+
+TEST(SourceManager, Metadata) {
+    auto id = tiny::SourceManager::get().add(tiny::File{tiny::FileType::Source, "m.ty"},
+                                             std::make_shared<const tiny::Source>(std::string("first\n  a = b + c\n")));
+
+    tiny::Metadata meta(id, 12, 13);
+    ASSERT_EQ(meta.getFile().path, "m.ty");
+    ASSERT_EQ(meta.getPosition(), std::make_pair(std::uint64_t(2), std::uint64_t(7)));
+    ASSERT_EQ(meta.getContext().first, "a = b + c");
+}
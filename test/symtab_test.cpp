@@ -0,0 +1,37 @@
+#include "gtest/gtest.h"
+
+#include "ast.h"
+#include "symtab.h"
+
+TEST(SymbolTable, DeepOperation) {
+    // a + (a + (a + ...)), deeper than what a recursive walk can handle
+    constexpr std::size_t depth = 200000;
+
+    tiny::ASTArena arena;
+    auto identifier = [&arena]() {
+        return arena.add(tiny::ASTNode(tiny::Metadata(), tiny::ASTNodeType::Identifier, tiny::Symbol("a")));
+    };
+
+    auto root = arena.add(tiny::ASTNode(tiny::Metadata(), tiny::ASTNodeType::OpAddition));
+    auto last = root;
+    for (std::size_t i = 1; i<depth; i++) {
+        auto node = arena.add(tiny::ASTNode(tiny::Metadata(), tiny::ASTNodeType::OpAddition));
+        last.addChildren(identifier());
+        last.addChildren(node);
+        last = node;
+    }
+
+    last.addChildren(identifier());
+    last.addChildren(arena.add(tiny::ASTNode(tiny::Metadata(), tiny::ASTNodeType::LiteralInt, std::int64_t(1))));
+
+    auto rootId = root.getId();
+    tiny::ASTFile file(tiny::File(), tiny::Symbol("test"), {}, std::move(arena), {rootId});
+    tiny::SymbolTable table(file);
+    table.build();
+
+    // The literal in the innermost operation makes every identifier of the chain numeric
+    auto &promises = table.getActive()->promises;
+    ASSERT_EQ(promises.size(), 2 * depth);
+    ASSERT_EQ(promises.front().assertion, tiny::Assertion::IsDefined);
+    ASSERT_EQ(promises.back().assertion, tiny::Assertion::IsNumeric);
+}
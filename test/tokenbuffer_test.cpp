@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+
+#include "tokenbuffer.h"
+
+TEST(TokenBuffer, SameAsLexemes) {
+    auto src = std::make_shared<const tiny::Source>(
+            std::string("module \"main\"\nfunc f(int a) -> (float b) { return a + 0x1F // done\n}"));
+    auto id = tiny::SourceManager::get().add(tiny::File{tiny::FileType::Source, "main.ty"}, src);
+
+    tiny::Lexer lexer{tiny::SourceStream(src)};
+    auto lexemes = lexer.lexAll();
+
+    tiny::Lexer lexer2{tiny::SourceStream(src)};
+    lexer2.setMetadataFile(id);
+    auto buffer = lexer2.tokenize();
+
+    ASSERT_EQ(buffer.size(), lexemes.size());
+    for (std::size_t i = 0; i < buffer.size(); i++) {
+        auto ref = buffer[i];
+        ASSERT_EQ(ref.getLexeme(), lexemes[i]);
+        ASSERT_EQ(ref.string(), lexemes[i].string());
+        ASSERT_EQ(ref.getMetadata().start, lexemes[i].metadata.start);
+        ASSERT_EQ(ref.getMetadata().end, lexemes[i].metadata.end);
+        ASSERT_EQ(ref.getMetadata().getFile().path, "main.ty");
+    }
+}
+
+TEST(TokenBuffer, Set) {
+    std::string src = "abc def";
+
+    tiny::TokenBuffer buffer(0, src);
+    buffer.resize(2);
+    ASSERT_EQ(buffer[1].token, tiny::Token::None);
+    ASSERT_TRUE(buffer[1].value.empty());
+
+    buffer.set(1, tiny::Lexeme(tiny::Token::Id, std::string_view(src).substr(4, 3), tiny::Metadata(0, 4, 7)));
+    ASSERT_EQ(buffer[1].value, "def");
+    ASSERT_EQ(buffer[1].start, 4);
+
+    buffer.set(0, buffer[1]);
+    ASSERT_EQ(buffer[0], buffer[1]);
+
+    // Values must come from the buffer's source
+    ASSERT_THROW(buffer.set(0, tiny::Lexeme(tiny::Token::Id, "abc", tiny::Metadata())), std::invalid_argument);
+}
+
+TEST(TokenBuffer, Numbers) {
+    std::string src = "1 2.5 x";
+    auto view = std::string_view(src);
+
+    tiny::TokenBuffer buffer(0, src);
+    buffer.resize(3);
+    buffer.set(2, tiny::Lexeme(tiny::Token::LiteralNum, view.substr(2, 3), 2.5L, tiny::Metadata(0, 2, 5)));
+    buffer.set(0, tiny::Lexeme(tiny::Token::LiteralNum, view.substr(0, 1), std::int64_t(1), tiny::Metadata(0, 0, 1)));
+    buffer.set(1, tiny::Lexeme(tiny::Token::Id, view.substr(6, 1), tiny::Metadata(0, 6, 7)));
+    ASSERT_EQ(buffer[0].number, tiny::Number(std::int64_t(1)));
+    ASSERT_EQ(buffer[1].number, tiny::Number());
+    ASSERT_EQ(buffer[2].number, tiny::Number(2.5L));
+
+    // Replacing a numeric literal drops its value
+    buffer.set(0, buffer[1]);
+    ASSERT_EQ(buffer[0].number, tiny::Number());
+
+    tiny::TokenBuffer copy(0, src);
+    copy.append(buffer, 1, 3, 0);
+    ASSERT_EQ(copy[1].number, tiny::Number(2.5L));
+
+    // Shrinking and growing back doesn't bring back old values
+    buffer.resize(2);
+    buffer.resize(3);
+    ASSERT_EQ(buffer[2].token, tiny::Token::None);
+    buffer.set(2, tiny::Lexeme(tiny::Token::LiteralNum, view.substr(0, 1), tiny::Number(), tiny::Metadata(0, 0, 1)));
+    ASSERT_EQ(buffer[2].number, tiny::Number());
+}
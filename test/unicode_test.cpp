@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+
+#include <unordered_map>
+
+#include "unicode.h"
+
+TEST(String, Narrow) {
+    tiny::String str("añb");
+
+    ASSERT_FALSE(str.isWide());
+    ASSERT_EQ(str.size(), 3);
+    ASSERT_EQ(str[1], 0xf1);
+    ASSERT_EQ(str.toString(), "añb");
+}
+
+TEST(String, Widen) {
+    tiny::String str("añ");
+    str += 0x20ac;
+
+    ASSERT_TRUE(str.isWide());
+    ASSERT_EQ(str.data(), std::vector<std::uint32_t>({'a', 0xf1, 0x20ac}));
+    ASSERT_EQ(str, tiny::String("añ€"));
+}
+
+TEST(String, Grow) {
+    tiny::String str;
+    std::string expected;
+    for (int i = 0; i < 100; i++) {
+        str += std::uint32_t('a' + i % 26);
+        expected += char('a' + i % 26);
+    }
+
+    ASSERT_EQ(str.toString(), expected);
+
+    str += 0x1f600;
+    ASSERT_EQ(str.size(), 101);
+    ASSERT_EQ(str.toString(), expected + "😀");
+
+    tiny::String copy(str);
+    ASSERT_EQ(copy, str);
+
+    tiny::String moved(std::move(copy));
+    ASSERT_EQ(moved, str);
+    ASSERT_TRUE(copy.empty());
+}
+
+TEST(String, Concatenate) {
+    tiny::String str = tiny::String("ab") + tiny::String("€") + "cd" + std::string("ñ");
+
+    ASSERT_EQ(str.toString(), "ab€cdñ");
+}
+
+TEST(String, Order) {
+    ASSERT_TRUE(tiny::String("a") < tiny::String("b"));
+    ASSERT_TRUE(tiny::String("a") < tiny::String("ab"));
+    ASSERT_TRUE(tiny::String("ñ") < tiny::String("€"));
+    ASSERT_FALSE(tiny::String("a€") < tiny::String("añ"));
+    ASSERT_FALSE(tiny::String("ab") < tiny::String("ab"));
+}
+
+TEST(String, Hash) {
+    tiny::String str("key");
+    tiny::String built;
+    built += 'k';
+    built += 'e';
+
+    auto partial = built.hash(); // Caches the hash, which must be dropped once the string changes
+    built += 'y';
+
+    ASSERT_NE(partial, built.hash());
+    ASSERT_EQ(str.hash(), built.hash());
+
+    std::unordered_map<tiny::String, int> map{{"key", 1}, {"ключ", 2}};
+    ASSERT_EQ(map.at(built), 1);
+    ASSERT_EQ(map.at("ключ"), 2);
+}
@@ -0,0 +1,77 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lexer.h"
+#include "parser.h"
+#include "visitor.h"
+
+namespace {
+    // Records the order in which identifiers are entered and additions are left
+    struct Trace : tiny::Pass<Trace> {
+        std::vector<std::string> events;
+
+        void enter(tiny::NodeTag<tiny::ASTNodeType::Identifier>, tiny::ConstNodeRef node, tiny::ConstNodeRef) {
+            events.push_back(node->getStringVal().toString());
+        }
+
+        void leave(tiny::NodeTag<tiny::ASTNodeType::OpAddition>, tiny::ConstNodeRef, tiny::ConstNodeRef parent) {
+            events.emplace_back(parent ? "+" : "+ (root)");
+        }
+    };
+
+    // Counts every node, but doesn't look inside function calls
+    struct CountOutsideCalls : tiny::Pass<CountOutsideCalls> {
+        int nodes = 0;
+
+        template<tiny::ASTNodeType T>
+        bool enter(tiny::NodeTag<T>, tiny::ConstNodeRef, tiny::ConstNodeRef) {
+            nodes++;
+            return T != tiny::ASTNodeType::FunctionCall;
+        }
+    };
+}
+
+static tiny::ASTFile parseFile(const std::string &code) {
+    auto src = std::make_shared<const tiny::Source>("module test\n" + code + "\n");
+    tiny::Lexer lexer{tiny::SourceStream(src)};
+    tiny::Parser parser(lexer);
+
+    return parser.file(tiny::File());
+}
+
+TEST(Visitor, Hooks) {
+    auto file = parseFile("a + f(b + c)");
+
+    Trace trace;
+    trace.run(file);
+    ASSERT_EQ(trace.events, (std::vector<std::string>{"a", "f", "b", "c", "+", "+"}));
+
+    // OpAddition(Identifier, FunctionCall(Identifier, FunctionCallArgumentList(OpAddition(Identifier, Identifier))))
+    CountOutsideCalls count;
+    count.run(file.nodes.get(file.statements.at(0)).getFirstChild());
+    ASSERT_EQ(count.nodes, 3);
+
+    trace.events.clear();
+    trace.run(file.nodes.get(file.statements.at(0)).getFirstChild());
+    ASSERT_EQ(trace.events.back(), "+ (root)");
+}
+
+TEST(Visitor, FusedPasses) {
+    auto file = parseFile("x := a + f(b + c)\ny := f(d) + e");
+
+    Trace alone;
+    alone.run(file);
+    CountOutsideCalls countAlone;
+    countAlone.run(file);
+
+    // A pass skipping a subtree doesn't hide it from the others
+    Trace fused;
+    CountOutsideCalls countFused;
+    tiny::visit(file, countFused, fused);
+
+    ASSERT_EQ(fused.events, alone.events);
+    ASSERT_EQ(countFused.nodes, countAlone.nodes);
+}